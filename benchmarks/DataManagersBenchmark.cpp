@@ -0,0 +1,363 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2026 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "../src/core/BookmarksModel.h"
+#include "../src/core/Console.h"
+#include "../src/core/HistoryManager.h"
+#include "../src/core/SessionsManager.h"
+#include "../src/core/SettingsManager.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QProcess>
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QTextStream>
+#include <QtCore/QXmlStreamWriter>
+#include <QtWidgets/QApplication>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace Otter;
+
+namespace
+{
+
+const QStringList hosts({QLatin1String("example.com"), QLatin1String("otter-browser.org"), QLatin1String("wikipedia.org"), QLatin1String("kernel.org"), QLatin1String("qt.io"), QLatin1String("news.example.net"), QLatin1String("forum.example.org"), QLatin1String("search.example.com")});
+const QStringList prefixes({QLatin1String("e"), QLatin1String("ex"), QLatin1String("otter"), QLatin1String("wiki"), QLatin1String("http://qt"), QLatin1String("forum.example.org/thread/1"), QLatin1String("nomatch")});
+
+QUrl createUrl(QRandomGenerator *generator, int index)
+{
+	return QUrl(QStringLiteral("https://%1/%2/%3?id=%4").arg(hosts.at(static_cast<int>(generator->bounded(hosts.count()))), ((index % 3 == 0) ? QLatin1String("thread") : QLatin1String("page")), QString::number(generator->bounded(100000)), QString::number(index)));
+}
+
+qint64 getPeakMemoryUsage()
+{
+#ifdef Q_OS_UNIX
+	rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+#ifdef Q_OS_DARWIN
+		return (usage.ru_maxrss / 1024);
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+
+	return -1;
+}
+
+bool createHistory(const QString &path, int amount)
+{
+	QRandomGenerator generator(amount);
+	QDateTime dateTime(QDateTime::currentDateTimeUtc().addDays(-365));
+	const qint64 step(qMax(qint64(1), ((365LL * 24 * 3600) / amount)));
+	QJsonArray historyArray;
+
+	for (int i = 0; i < amount; ++i)
+	{
+		dateTime = dateTime.addSecs(step);
+
+		historyArray.append(QJsonObject({{QLatin1String("url"), createUrl(&generator, i).toString()}, {QLatin1String("title"), QStringLiteral("Page %1").arg(i)}, {QLatin1String("time"), dateTime.toString(Qt::ISODate)}}));
+	}
+
+	QSaveFile file(path);
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
+
+	file.write(QJsonDocument(historyArray).toJson(QJsonDocument::Compact));
+
+	return file.commit();
+}
+
+bool createBookmarks(const QString &path, int amount)
+{
+	QRandomGenerator generator(amount);
+	QSaveFile file(path);
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
+
+	QXmlStreamWriter writer(&file);
+	writer.writeStartDocument();
+	writer.writeDTD(QLatin1String("<!DOCTYPE xbel>"));
+	writer.writeStartElement(QLatin1String("xbel"));
+	writer.writeAttribute(QLatin1String("version"), QLatin1String("1.0"));
+
+	const int folderSize(500);
+
+	for (int i = 0; i < amount; ++i)
+	{
+		if (i % folderSize == 0)
+		{
+			if (i > 0)
+			{
+				writer.writeEndElement();
+			}
+
+			writer.writeStartElement(QLatin1String("folder"));
+			writer.writeTextElement(QLatin1String("title"), QStringLiteral("Folder %1").arg(i / folderSize));
+		}
+
+		writer.writeStartElement(QLatin1String("bookmark"));
+		writer.writeAttribute(QLatin1String("href"), createUrl(&generator, i).toString());
+		writer.writeTextElement(QLatin1String("title"), QStringLiteral("Bookmark %1").arg(i));
+
+		if (i % 50 == 0)
+		{
+			writer.writeStartElement(QLatin1String("info"));
+			writer.writeStartElement(QLatin1String("metadata"));
+			writer.writeAttribute(QLatin1String("owner"), QLatin1String("http://otter-browser.org/otter-xbel-bookmark"));
+			writer.writeTextElement(QLatin1String("keyword"), QStringLiteral("kw%1").arg(i));
+			writer.writeEndElement();
+			writer.writeEndElement();
+		}
+
+		writer.writeEndElement();
+	}
+
+	if (amount > 0)
+	{
+		writer.writeEndElement();
+	}
+
+	writer.writeEndDocument();
+
+	return file.commit();
+}
+
+qint64 measureFindEntries()
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	for (const QString &prefix: prefixes)
+	{
+		HistoryManager::findEntries(prefix);
+	}
+
+	return (timer.nsecsElapsed() / prefixes.count());
+}
+
+qint64 measureFindBookmarks(const BookmarksModel *model)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	for (const QString &prefix: prefixes)
+	{
+		model->findBookmarks(prefix);
+	}
+
+	model->findBookmarks(QLatin1String("kw1"));
+
+	return (timer.nsecsElapsed() / (prefixes.count() + 1));
+}
+
+void createProfile(const QString &path)
+{
+	Console::createInstance();
+
+	SettingsManager::createInstance(path);
+
+	SessionsManager::createInstance(path, QDir(path).filePath(QLatin1String("cache")), false, false);
+}
+
+QJsonObject runHistoryBenchmark(const QString &path)
+{
+	createProfile(path);
+
+	HistoryManager::createInstance();
+	HistoryManager::getTypedHistoryModel();
+
+	const qint64 initialMemoryUsage(getPeakMemoryUsage());
+	QElapsedTimer timer;
+	timer.start();
+
+	HistoryModel *model(HistoryManager::getBrowsingHistoryModel());
+	const qint64 loadTime(timer.nsecsElapsed());
+	const qint64 findTime(measureFindEntries());
+
+	timer.restart();
+
+	model->save(QDir(path).filePath(QLatin1String("browsingHistory-saved.json")));
+
+	const qint64 saveTime(timer.nsecsElapsed());
+
+	return QJsonObject({{QLatin1String("entries"), model->rowCount()}, {QLatin1String("loadNs"), loadTime}, {QLatin1String("findEntriesNs"), findTime}, {QLatin1String("saveNs"), saveTime}, {QLatin1String("peakRssKb"), getPeakMemoryUsage()}, {QLatin1String("rssDeltaKb"), (getPeakMemoryUsage() - initialMemoryUsage)}});
+}
+
+QJsonObject runBookmarksBenchmark(const QString &path)
+{
+	const QString bookmarksPath(QDir(path).filePath(QLatin1String("bookmarks-generated.xbel")));
+
+	createProfile(path);
+
+	const qint64 initialMemoryUsage(getPeakMemoryUsage());
+	QElapsedTimer timer;
+	timer.start();
+
+	BookmarksModel *model(new BookmarksModel(bookmarksPath, BookmarksModel::BookmarksMode));
+	const qint64 constructTime(timer.nsecsElapsed());
+
+	if (model->isLoading())
+	{
+		QEventLoop eventLoop;
+
+		QObject::connect(model, &BookmarksModel::loadingFinished, &eventLoop, &QEventLoop::quit);
+
+		eventLoop.exec();
+	}
+
+	const qint64 loadTime(timer.nsecsElapsed());
+	const qint64 findTime(measureFindBookmarks(model));
+
+	timer.restart();
+
+	model->save(QDir(path).filePath(QLatin1String("bookmarks-saved.xbel")));
+
+	const qint64 saveTime(timer.nsecsElapsed());
+	const QJsonObject result({{QLatin1String("bookmarks"), model->getCount()}, {QLatin1String("constructNs"), constructTime}, {QLatin1String("loadNs"), loadTime}, {QLatin1String("findBookmarksNs"), findTime}, {QLatin1String("saveNs"), saveTime}, {QLatin1String("peakRssKb"), getPeakMemoryUsage()}, {QLatin1String("rssDeltaKb"), (getPeakMemoryUsage() - initialMemoryUsage)}});
+
+	delete model;
+
+	return result;
+}
+
+QJsonObject runProfile(const QString &option, const QString &path)
+{
+	QProcess process;
+	process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+	process.start(QCoreApplication::applicationFilePath(), {QLatin1String("--") + option, path});
+
+	if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+	{
+		QTextStream(stderr) << "Failed to run " << option << " benchmark for " << path << '\n';
+
+		return {};
+	}
+
+	return QJsonDocument::fromJson(process.readAllStandardOutput()).object();
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	QApplication application(argc, argv);
+	application.setApplicationName(QLatin1String("otter-browser-benchmark"));
+
+	QCommandLineOption historyProfileOption(QLatin1String("history-profile"), QLatin1String("Runs history benchmark for single profile."), QLatin1String("path"));
+	historyProfileOption.setFlags(QCommandLineOption::HiddenFromHelp);
+
+	QCommandLineOption bookmarksProfileOption(QLatin1String("bookmarks-profile"), QLatin1String("Runs bookmarks benchmark for single profile."), QLatin1String("path"));
+	bookmarksProfileOption.setFlags(QCommandLineOption::HiddenFromHelp);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(QLatin1String("Measures scalability of history and bookmarks data managers"));
+	parser.addHelpOption();
+	parser.addOption(QCommandLineOption(QLatin1String("history"), QLatin1String("Comma separated amounts of history entries to generate."), QLatin1String("amounts"), QLatin1String("10000,100000,1000000")));
+	parser.addOption(QCommandLineOption(QLatin1String("bookmarks"), QLatin1String("Amount of bookmarks to generate."), QLatin1String("amount"), QLatin1String("50000")));
+	parser.addOption(QCommandLineOption(QLatin1String("output"), QLatin1String("Writes results to file instead of standard output."), QLatin1String("path")));
+	parser.addOption(historyProfileOption);
+	parser.addOption(bookmarksProfileOption);
+	parser.process(application);
+
+	if (parser.isSet(historyProfileOption) || parser.isSet(bookmarksProfileOption))
+	{
+		// Each profile is measured in its own process, so that peak memory usage and managers state are not shared
+		const QJsonObject result(parser.isSet(historyProfileOption) ? runHistoryBenchmark(parser.value(historyProfileOption)) : runBookmarksBenchmark(parser.value(bookmarksProfileOption)));
+
+		if (result.isEmpty())
+		{
+			return 1;
+		}
+
+		QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact);
+
+		return 0;
+	}
+
+	QJsonArray historyResults;
+	const QStringList historyAmounts(parser.value(QLatin1String("history")).split(QLatin1Char(','), Qt::SkipEmptyParts));
+
+	for (const QString &rawAmount: historyAmounts)
+	{
+		const int amount(rawAmount.toInt());
+		QTemporaryDir profileDirectory;
+
+		if (amount <= 0 || !profileDirectory.isValid() || !createHistory(profileDirectory.filePath(QLatin1String("browsingHistory.json")), amount))
+		{
+			continue;
+		}
+
+		const QJsonObject result(runProfile(QLatin1String("history-profile"), profileDirectory.path()));
+
+		if (!result.isEmpty())
+		{
+			historyResults.append(result);
+		}
+	}
+
+	QJsonObject bookmarksResult;
+	const int bookmarksAmount(parser.value(QLatin1String("bookmarks")).toInt());
+	QTemporaryDir profileDirectory;
+
+	if (bookmarksAmount > 0 && profileDirectory.isValid() && createBookmarks(profileDirectory.filePath(QLatin1String("bookmarks-generated.xbel")), bookmarksAmount))
+	{
+		bookmarksResult = runProfile(QLatin1String("bookmarks-profile"), profileDirectory.path());
+	}
+
+	const QByteArray result(QJsonDocument(QJsonObject({{QLatin1String("history"), historyResults}, {QLatin1String("bookmarks"), bookmarksResult}})).toJson());
+
+	if (parser.isSet(QLatin1String("output")))
+	{
+		QSaveFile file(parser.value(QLatin1String("output")));
+
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			QTextStream(stderr) << "Failed to write results: " << file.errorString() << '\n';
+
+			return 1;
+		}
+
+		file.write(result);
+
+		return (file.commit() ? 0 : 1);
+	}
+
+	QTextStream(stdout) << result;
+
+	return 0;
+}
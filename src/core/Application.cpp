@@ -22,6 +22,7 @@
 #include "AddonsManager.h"
 #include "BookmarksManager.h"
 #include "Console.h"
+#include "FaviconsManager.h"
 #include "FeedsManager.h"
 #include "GesturesManager.h"
 #include "HandlersManager.h"
@@ -50,6 +51,7 @@
 #elif defined(Q_OS_UNIX)
 #include "../modules/platforms/freedesktoporg/FreeDesktopOrgPlatformIntegration.h"
 #endif
+#include "../modules/widgets/address/AddressCompletionModel.h"
 #include "../ui/DataExchangerDialog.h"
 #include "../ui/DiagnosticReportDialog.h"
 #include "../ui/LocaleDialog.h"
@@ -264,6 +266,11 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 				reportOptions |= PathsReport;
 			}
 
+			if (rawReportOptions.contains(QLatin1String("performance")))
+			{
+				reportOptions |= PerformanceReport;
+			}
+
 			if (rawReportOptions.contains(QLatin1String("settings")))
 			{
 				reportOptions |= SettingsReport;
@@ -426,6 +433,8 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 
 	BookmarksManager::createInstance();
 
+	FaviconsManager::createInstance();
+
 	FeedsManager::createInstance();
 
 	GesturesManager::createInstance();
@@ -1449,6 +1458,11 @@ QString Application::createReport(ReportOptions options)
 		report.sections.append(ActionsManager::createReport());
 	}
 
+	if (options.testFlag(PerformanceReport))
+	{
+		report.sections.append(AddressCompletionModel::createReport());
+	}
+
 	QString reportString;
 	QTextStream stream(&reportString);
 	stream.setFieldAlignment(QTextStream::AlignLeft);
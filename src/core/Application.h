@@ -51,8 +51,9 @@ public:
 		KeyboardShortcutsReport = 2,
 		PathsReport = 4,
 		SettingsReport = 8,
-		StandardReport = (EnvironmentReport | PathsReport | SettingsReport),
-		FullReport = (EnvironmentReport | KeyboardShortcutsReport | PathsReport | SettingsReport)
+		PerformanceReport = 16,
+		StandardReport = (EnvironmentReport | PathsReport | SettingsReport | PerformanceReport),
+		FullReport = (EnvironmentReport | KeyboardShortcutsReport | PathsReport | SettingsReport | PerformanceReport)
 	};
 
 	Q_DECLARE_FLAGS(ReportOptions, ReportOption)
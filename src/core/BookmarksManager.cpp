@@ -46,7 +46,7 @@ void BookmarksManager::timerEvent(QTimerEvent *event)
 
 		if (m_model)
 		{
-			m_model->save(SessionsManager::getWritableDataPath(QLatin1String("bookmarks.xbel")));
+			m_model->compact();
 		}
 	}
 }
@@ -87,7 +87,7 @@ void BookmarksManager::scheduleSave()
 
 		if (m_model)
 		{
-			m_model->save(SessionsManager::getWritableDataPath(QLatin1String("bookmarks.xbel")));
+			m_model->compact(false);
 		}
 	}
 	else if (m_saveTimer == 0)
@@ -26,10 +26,17 @@
 #include "ThemesManager.h"
 #include "Utils.h"
 
+#include <QtCore/QBuffer>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
 #include <QtCore/QMimeData>
+#include <QtCore/QPointer>
 #include <QtCore/QSaveFile>
+#include <QtCore/QThreadPool>
 #include <QtCore/QTimeZone>
 #include <QtWidgets/QMessageBox>
 
@@ -376,7 +383,13 @@ BookmarksModel::BookmarksModel(const QString &path, FormatMode mode, QObject *pa
 	m_rootItem(new Bookmark()),
 	m_trashItem(new Bookmark()),
 	m_importTargetItem(nullptr),
-	m_mode(mode)
+	m_compactionState(new CompactionState()),
+	m_path(path),
+	m_mode(mode),
+	m_journalEntries(0),
+	m_isLoading(false),
+	m_isCompacting(false),
+	m_needsCompaction(false)
 {
 	m_rootItem->setData(RootBookmark, TypeRole);
 	m_rootItem->setDragEnabled(false);
@@ -388,55 +401,29 @@ BookmarksModel::BookmarksModel(const QString &path, FormatMode mode, QObject *pa
 	appendRow(m_trashItem);
 	setItemPrototype(new Bookmark());
 
-	if (!QFile::exists(path))
+	if (!QFile::exists(path) && !QFile::exists(path + QLatin1String(".journal")))
 	{
-		return;
-	}
-
-	QFile file(path);
-	const bool isNotes(m_mode == NotesMode);
-
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		Console::addMessage((isNotes ? tr("Failed to open notes file: %1") : tr("Failed to open bookmarks file: %1")).arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, path);
+		m_checksum = createChecksum({});
 
 		return;
 	}
 
-	QXmlStreamReader reader(&file);
+	m_isLoading = true;
 
-	if (reader.readNextStartElement() && reader.name() == QLatin1String("xbel") && reader.attributes().value(QLatin1String("version")).toString() == QLatin1String("1.0"))
+	const QPointer<BookmarksModel> model(this);
+
+	QThreadPool::globalInstance()->start([=]()
 	{
-		while (reader.readNextStartElement())
+		const BookmarksTree tree(readBookmarks(path));
+
+		QMetaObject::invokeMethod(QCoreApplication::instance(), [=]()
 		{
-			if (reader.name() == QLatin1String("folder") || reader.name() == QLatin1String("bookmark") || reader.name() == QLatin1String("separator"))
+			if (model)
 			{
-				readBookmark(&reader, m_rootItem);
+				model->handleLoadingFinished(tree, path);
 			}
-			else
-			{
-				reader.skipCurrentElement();
-			}
-
-			if (reader.hasError())
-			{
-				m_rootItem->removeRows(0, m_rootItem->rowCount());
-
-				Console::addMessage((isNotes ? tr("Failed to load notes file: %1") : tr("Failed to load bookmarks file: %1")).arg(reader.errorString()), Console::OtherCategory, Console::ErrorLevel, path);
-
-				QMessageBox::warning(nullptr, tr("Error"), (isNotes ? tr("Failed to load notes file.") : tr("Failed to load bookmarks file.")), QMessageBox::Close);
-
-				return;
-			}
-		}
-	}
-
-	connect(this, &BookmarksModel::itemChanged, this, &BookmarksModel::modelModified);
-	connect(this, &BookmarksModel::rowsInserted, this, &BookmarksModel::modelModified);
-	connect(this, &BookmarksModel::rowsInserted, this, &BookmarksModel::notifyBookmarkModified);
-	connect(this, &BookmarksModel::rowsRemoved, this, &BookmarksModel::modelModified);
-	connect(this, &BookmarksModel::rowsRemoved, this, &BookmarksModel::notifyBookmarkModified);
-	connect(this, &BookmarksModel::rowsMoved, this, &BookmarksModel::modelModified);
+		}, Qt::QueuedConnection);
+	});
 }
 
 void BookmarksModel::beginImport(Bookmark *target, int estimatedUrlsAmount, int estimatedKeywordsAmount)
@@ -462,6 +449,8 @@ void BookmarksModel::endImport()
 	m_urls.squeeze();
 	m_keywords.squeeze();
 
+	m_needsCompaction = true;
+
 	blockSignals(false);
 	endResetModel();
 
@@ -475,6 +464,105 @@ void BookmarksModel::endImport()
 	emit modelModified();
 }
 
+void BookmarksModel::compact(bool isAsynchronous)
+{
+	if (m_isLoading || SessionsManager::isReadOnly())
+	{
+		return;
+	}
+
+	if (m_isCompacting)
+	{
+		if (isAsynchronous)
+		{
+			return;
+		}
+
+		// Result of running compaction would be never delivered once event loop is gone, so redo it
+		m_needsCompaction = true;
+	}
+	else if (!m_needsCompaction && m_journalEntries < 1000)
+	{
+		return;
+	}
+
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+
+	writeBookmarks(&buffer);
+
+	const QByteArray checksum(createChecksum(data));
+	const QString path(m_path);
+	QFile journalFile(m_path + QLatin1String(".journal"));
+
+	if (journalFile.open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		if (journalFile.size() == 0)
+		{
+			journalFile.write(QJsonDocument(QJsonObject({{QLatin1String("checksum"), QString::fromLatin1(m_checksum)}})).toJson(QJsonDocument::Compact) + '\n');
+		}
+
+		journalFile.write(QJsonDocument(QJsonObject({{QLatin1String("operation"), QLatin1String("snapshot")}, {QLatin1String("checksum"), QString::fromLatin1(checksum)}})).toJson(QJsonDocument::Compact) + '\n');
+		journalFile.close();
+	}
+
+	const qint64 offset(QFileInfo(m_path + QLatin1String(".journal")).size());
+
+	m_isCompacting = true;
+	m_needsCompaction = false;
+
+	if (!isAsynchronous)
+	{
+		QMutexLocker locker(&m_compactionState->mutex);
+
+		// Waits for write already in progress and makes queued one obsolete
+		++m_compactionState->generation;
+
+		QSaveFile file(path);
+		const bool isSuccess(file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit());
+
+		locker.unlock();
+
+		handleCompactionFinished(checksum, offset, isSuccess);
+
+		return;
+	}
+
+	const QPointer<BookmarksModel> model(this);
+	const QSharedPointer<CompactionState> state(m_compactionState);
+	int generation(0);
+
+	{
+		QMutexLocker locker(&state->mutex);
+
+		generation = state->generation;
+	}
+
+	QThreadPool::globalInstance()->start([=]()
+	{
+		QMutexLocker locker(&state->mutex);
+
+		if (state->generation != generation)
+		{
+			return;
+		}
+
+		QSaveFile file(path);
+		const bool isSuccess(file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit());
+
+		locker.unlock();
+
+		QMetaObject::invokeMethod(QCoreApplication::instance(), [=]()
+		{
+			if (model)
+			{
+				model->handleCompactionFinished(checksum, offset, isSuccess);
+			}
+		}, Qt::QueuedConnection);
+	});
+}
+
 void BookmarksModel::trashBookmark(Bookmark *bookmark)
 {
 	if (!bookmark)
@@ -503,6 +591,8 @@ void BookmarksModel::trashBookmark(Bookmark *bookmark)
 
 	m_trash[bookmark] = location;
 
+	appendJournal({{QLatin1String("operation"), QLatin1String("trash")}, {QLatin1String("parent"), static_cast<qint64>(previousParent->getIdentifier())}, {QLatin1String("row"), location.row}});
+
 	m_trashItem->appendRow(bookmark->parent()->takeRow(bookmark->row()));
 	m_trashItem->setEnabled(true);
 
@@ -542,6 +632,8 @@ void BookmarksModel::restoreBookmark(Bookmark *bookmark)
 
 	m_trashItem->setEnabled(m_trashItem->hasChildren());
 
+	appendJournal({{QLatin1String("operation"), QLatin1String("add")}, {QLatin1String("parent"), static_cast<qint64>(previousParent->getIdentifier())}, {QLatin1String("row"), bookmark->row()}, {QLatin1String("bookmark"), createJournalNode(bookmark)}});
+
 	emit bookmarkModified(bookmark);
 	emit bookmarkRestored(bookmark);
 	emit modelModified();
@@ -555,33 +647,323 @@ void BookmarksModel::removeBookmark(Bookmark *bookmark)
 	}
 
 	removeBookmarkUrl(bookmark);
+	removeBookmarkIdentifier(bookmark);
 
-	const quint64 identifier(bookmark->data(IdentifierRole).toULongLong());
+	if (!isTrashed(bookmark))
+	{
+		appendJournal({{QLatin1String("operation"), QLatin1String("trash")}, {QLatin1String("parent"), static_cast<qint64>(bookmark->getParent()->getIdentifier())}, {QLatin1String("row"), bookmark->row()}});
+	}
+
+	emit bookmarkRemoved(bookmark, bookmark->getParent());
+
+	bookmark->parent()->removeRow(bookmark->row());
 
-	if (identifier > 0 && m_identifiers.contains(identifier))
+	emit modelModified();
+}
+
+void BookmarksModel::attachBookmarks(const QVector<BookmarkNode> &nodes, Bookmark *parent, int index)
+{
+	for (int i = 0; i < nodes.count(); ++i)
 	{
-		m_identifiers.remove(identifier);
+		const BookmarkNode &node(nodes.at(i));
+		Bookmark *bookmark(addBookmark(node.type, node.metaData, parent, (index + i)));
+		QMap<int, QVariant>::const_iterator iterator;
+
+		for (iterator = node.itemData.constBegin(); iterator != node.itemData.constEnd(); ++iterator)
+		{
+			bookmark->setItemData(iterator.value(), iterator.key());
+		}
+
+		if (node.itemData.contains(KeywordRole))
+		{
+			handleKeywordChanged(bookmark, node.itemData[KeywordRole].toString());
+		}
+
+		if (node.type == FeedBookmark)
+		{
+			setupFeed(bookmark);
+		}
+
+		attachBookmarks(node.children, bookmark);
 	}
+}
 
-	if (!bookmark->data(KeywordRole).toString().isEmpty() && m_keywords.contains(bookmark->data(KeywordRole).toString()))
+void BookmarksModel::replayJournal(const QVector<QJsonObject> &journal)
+{
+	for (const QJsonObject &entry: journal)
 	{
-		m_keywords.remove(bookmark->data(KeywordRole).toString());
+		const QString operation(entry.value(QLatin1String("operation")).toString());
+
+		if (operation == QLatin1String("modify"))
+		{
+			Bookmark *bookmark(getBookmark(entry.value(QLatin1String("identifier")).toVariant().toULongLong()));
+
+			if (!bookmark || bookmark == m_rootItem)
+			{
+				m_needsCompaction = true;
+
+				continue;
+			}
+
+			const QJsonObject dataObject(entry.value(QLatin1String("data")).toObject());
+
+			for (int i = TitleRole; i < UserRole; ++i)
+			{
+				const QString key(getJournalKey(i));
+
+				if (!key.isEmpty() && dataObject.contains(key))
+				{
+					setData(bookmark->index(), readJournalValue(dataObject.value(key), i), i);
+				}
+			}
+
+			continue;
+		}
+
+		Bookmark *parent(getBookmark(entry.value(QLatin1String("parent")).toVariant().toULongLong()));
+		const int row(entry.value(QLatin1String("row")).toInt());
+
+		if (!parent || row < 0 || row > parent->rowCount())
+		{
+			m_needsCompaction = true;
+
+			continue;
+		}
+
+		if (operation == QLatin1String("add"))
+		{
+			attachBookmarks({readJournalNode(entry.value(QLatin1String("bookmark")).toObject())}, parent, row);
+
+			continue;
+		}
+
+		Bookmark *bookmark(parent->getChild(row));
+
+		if (!bookmark)
+		{
+			m_needsCompaction = true;
+
+			continue;
+		}
+
+		if (operation == QLatin1String("move"))
+		{
+			Bookmark *newParent(getBookmark(entry.value(QLatin1String("newParent")).toVariant().toULongLong()));
+
+			if (!newParent || bookmark == newParent || bookmark->isAncestorOf(newParent))
+			{
+				m_needsCompaction = true;
+
+				continue;
+			}
+
+			const QList<QStandardItem*> items(parent->takeRow(row));
+
+			newParent->insertRow(qBound(0, entry.value(QLatin1String("newRow")).toInt(), newParent->rowCount()), items);
+		}
+		else if (operation == QLatin1String("trash"))
+		{
+			removeBookmark(bookmark);
+		}
+		else
+		{
+			m_needsCompaction = true;
+		}
 	}
+}
 
-	emit bookmarkRemoved(bookmark, bookmark->getParent());
+void BookmarksModel::appendJournal(const QJsonObject &object)
+{
+	if (m_isLoading || signalsBlocked() || SessionsManager::isReadOnly())
+	{
+		return;
+	}
 
-	bookmark->parent()->removeRow(bookmark->row());
+	QFile file(m_path + QLatin1String(".journal"));
 
-	emit modelModified();
+	if (m_checksum.isEmpty() || !file.open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		m_needsCompaction = true;
+
+		return;
+	}
+
+	if (file.size() == 0)
+	{
+		file.write(QJsonDocument(QJsonObject({{QLatin1String("checksum"), QString::fromLatin1(m_checksum)}})).toJson(QJsonDocument::Compact) + '\n');
+	}
+
+	file.write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+
+	++m_journalEntries;
+}
+
+void BookmarksModel::handleLoadingFinished(const BookmarksTree &tree, const QString &path)
+{
+	m_isLoading = false;
+	m_checksum = tree.checksum;
+
+	const bool isNotes(m_mode == NotesMode);
+
+	if (!tree.isOpened)
+	{
+		Console::addMessage((isNotes ? tr("Failed to open notes file: %1") : tr("Failed to open bookmarks file: %1")).arg(tree.errorString), Console::OtherCategory, Console::ErrorLevel, path);
+
+		emit loadingFinished();
+
+		return;
+	}
+
+	if (!tree.errorString.isEmpty())
+	{
+		Console::addMessage((isNotes ? tr("Failed to load notes file: %1") : tr("Failed to load bookmarks file: %1")).arg(tree.errorString), Console::OtherCategory, Console::ErrorLevel, path);
+
+		QMessageBox::warning(nullptr, tr("Error"), (isNotes ? tr("Failed to load notes file.") : tr("Failed to load bookmarks file.")), QMessageBox::Close);
+
+		emit loadingFinished();
+
+		return;
+	}
+
+	const QMap<quint64, Bookmark*> identifiers(m_identifiers);
+	const bool wasModified(m_rootItem->hasChildren() || m_trashItem->hasChildren());
+
+	m_identifiers.clear();
+
+	beginResetModel();
+	blockSignals(true);
+
+	attachBookmarks(tree.bookmarks, m_rootItem);
+	replayJournal(tree.journal);
+
+	QMap<quint64, Bookmark*>::const_iterator iterator;
+
+	for (iterator = identifiers.constBegin(); iterator != identifiers.constEnd(); ++iterator)
+	{
+		quint64 identifier(iterator.key());
+
+		if (m_identifiers.contains(identifier))
+		{
+			identifier = (m_identifiers.lastKey() + 1);
+
+			iterator.value()->setItemData(identifier, IdentifierRole);
+		}
+
+		m_identifiers[identifier] = iterator.value();
+	}
+
+	m_urls.squeeze();
+	m_keywords.squeeze();
+
+	m_journalEntries = tree.journal.count();
+
+	if (tree.isJournalOutdated)
+	{
+		const QString journalPath(m_path + QLatin1String(".journal"));
+
+		if (QFile::exists(journalPath))
+		{
+			// Keep changes recorded against different snapshot, it might be the snapshot that is broken
+			QFile::remove(journalPath + QLatin1String(".old"));
+			QFile::rename(journalPath, journalPath + QLatin1String(".old"));
+
+			Console::addMessage((isNotes ? tr("Notes journal does not match notes file, moved it aside") : tr("Bookmarks journal does not match bookmarks file, moved it aside")), Console::OtherCategory, Console::WarningLevel, journalPath);
+		}
+	}
+
+	if (wasModified || tree.isJournalDamaged)
+	{
+		m_needsCompaction = true;
+	}
+
+	blockSignals(false);
+	endResetModel();
+
+	connect(this, &BookmarksModel::itemChanged, this, &BookmarksModel::modelModified);
+	connect(this, &BookmarksModel::rowsInserted, this, &BookmarksModel::modelModified);
+	connect(this, &BookmarksModel::rowsInserted, this, &BookmarksModel::notifyBookmarkModified);
+	connect(this, &BookmarksModel::rowsRemoved, this, &BookmarksModel::modelModified);
+	connect(this, &BookmarksModel::rowsRemoved, this, &BookmarksModel::notifyBookmarkModified);
+	connect(this, &BookmarksModel::rowsMoved, this, &BookmarksModel::modelModified);
+
+	emit loadingFinished();
+
+	if (m_needsCompaction)
+	{
+		emit modelModified();
+	}
 }
 
-void BookmarksModel::readBookmark(QXmlStreamReader *reader, Bookmark *parent)
+void BookmarksModel::handleCompactionFinished(const QByteArray &checksum, qint64 offset, bool isSuccess)
 {
-	Bookmark *bookmark(nullptr);
+	if (!m_isCompacting)
+	{
+		return;
+	}
+
+	m_isCompacting = false;
+
+	if (!isSuccess)
+	{
+		m_needsCompaction = true;
+
+		Console::addMessage(((m_mode == NotesMode) ? tr("Failed to save notes file") : tr("Failed to save bookmarks file")), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		return;
+	}
+
+	const QString journalPath(m_path + QLatin1String(".journal"));
+	QFile journalFile(journalPath);
+	QByteArray journal;
+
+	if (journalFile.open(QIODevice::ReadOnly))
+	{
+		journalFile.seek(offset);
+
+		journal = journalFile.readAll();
+
+		journalFile.close();
+	}
+
+	if (offset == 0 && !journal.isEmpty())
+	{
+		journal = journal.mid(journal.indexOf('\n') + 1);
+	}
+
+	m_checksum = checksum;
+	m_journalEntries = journal.count('\n');
+
+	if (journal.isEmpty())
+	{
+		QFile::remove(journalPath);
+
+		return;
+	}
+
+	QSaveFile file(journalPath);
+
+	if (file.open(QIODevice::WriteOnly))
+	{
+		file.write(QJsonDocument(QJsonObject({{QLatin1String("checksum"), QString::fromLatin1(m_checksum)}})).toJson(QJsonDocument::Compact) + '\n');
+		file.write(journal);
+
+		if (file.commit())
+		{
+			return;
+		}
+	}
+
+	m_needsCompaction = true;
+}
+
+void BookmarksModel::readBookmark(QXmlStreamReader *reader, QVector<BookmarkNode> *nodes)
+{
+	BookmarkNode node;
 
 	if (reader->name() == QLatin1String("folder"))
 	{
-		bookmark = addBookmark(FolderBookmark, {{IdentifierRole, reader->attributes().value(QLatin1String("id")).toULongLong()}, {TimeAddedRole, readDateTime(reader, QLatin1String("added"))}, {TimeModifiedRole, readDateTime(reader, QLatin1String("modified"))}}, parent);
+		node.type = FolderBookmark;
+		node.metaData = {{IdentifierRole, reader->attributes().value(QLatin1String("id")).toULongLong()}, {TimeAddedRole, readDateTime(reader, QLatin1String("added"))}, {TimeModifiedRole, readDateTime(reader, QLatin1String("modified"))}};
 
 		while (reader->readNext())
 		{
@@ -589,15 +971,15 @@ void BookmarksModel::readBookmark(QXmlStreamReader *reader, Bookmark *parent)
 			{
 				if (reader->name() == QLatin1String("title"))
 				{
-					bookmark->setItemData(reader->readElementText().trimmed(), TitleRole);
+					node.itemData[TitleRole] = reader->readElementText().trimmed();
 				}
 				else if (reader->name() == QLatin1String("desc"))
 				{
-					bookmark->setItemData(reader->readElementText().trimmed(), DescriptionRole);
+					node.itemData[DescriptionRole] = reader->readElementText().trimmed();
 				}
 				else if (reader->name() == QLatin1String("folder") || reader->name() == QLatin1String("bookmark") || reader->name() == QLatin1String("separator"))
 				{
-					readBookmark(reader, bookmark);
+					readBookmark(reader, &node.children);
 				}
 				else if (reader->name() == QLatin1String("info"))
 				{
@@ -617,9 +999,7 @@ void BookmarksModel::readBookmark(QXmlStreamReader *reader, Bookmark *parent)
 
 											if (!keyword.isEmpty())
 											{
-												bookmark->setItemData(keyword, KeywordRole);
-
-												handleKeywordChanged(bookmark, keyword);
+												node.itemData[KeywordRole] = keyword;
 											}
 										}
 										else
@@ -661,9 +1041,8 @@ void BookmarksModel::readBookmark(QXmlStreamReader *reader, Bookmark *parent)
 	}
 	else if (reader->name() == QLatin1String("bookmark"))
 	{
-		const bool isFeed(reader->attributes().hasAttribute(QLatin1String("feed")));
-
-		bookmark = addBookmark((isFeed ? FeedBookmark : UrlBookmark), {{IdentifierRole, reader->attributes().value(QLatin1String("id")).toULongLong()}, {UrlRole, reader->attributes().value(QLatin1String("href")).toString()}, {TimeAddedRole, readDateTime(reader, QLatin1String("added"))}, {TimeModifiedRole, readDateTime(reader, QLatin1String("modified"))}, {TimeVisitedRole, readDateTime(reader, QLatin1String("visited"))}}, parent);
+		node.type = (reader->attributes().hasAttribute(QLatin1String("feed")) ? FeedBookmark : UrlBookmark);
+		node.metaData = {{IdentifierRole, reader->attributes().value(QLatin1String("id")).toULongLong()}, {UrlRole, reader->attributes().value(QLatin1String("href")).toString()}, {TimeAddedRole, readDateTime(reader, QLatin1String("added"))}, {TimeModifiedRole, readDateTime(reader, QLatin1String("modified"))}, {TimeVisitedRole, readDateTime(reader, QLatin1String("visited"))}};
 
 		while (reader->readNext())
 		{
@@ -671,11 +1050,11 @@ void BookmarksModel::readBookmark(QXmlStreamReader *reader, Bookmark *parent)
 			{
 				if (reader->name() == QLatin1String("title"))
 				{
-					bookmark->setItemData(reader->readElementText().trimmed(), TitleRole);
+					node.itemData[TitleRole] = reader->readElementText().trimmed();
 				}
 				else if (reader->name() == QLatin1String("desc"))
 				{
-					bookmark->setItemData(reader->readElementText().trimmed(), DescriptionRole);
+					node.itemData[DescriptionRole] = reader->readElementText().trimmed();
 				}
 				else if (reader->name() == QLatin1String("info"))
 				{
@@ -695,14 +1074,12 @@ void BookmarksModel::readBookmark(QXmlStreamReader *reader, Bookmark *parent)
 
 											if (!keyword.isEmpty())
 											{
-												bookmark->setItemData(keyword, KeywordRole);
-
-												handleKeywordChanged(bookmark, keyword);
+												node.itemData[KeywordRole] = keyword;
 											}
 										}
 										else if (reader->name() == QLatin1String("visits"))
 										{
-											bookmark->setItemData(reader->readElementText().toInt(), VisitsRole);
+											node.itemData[VisitsRole] = reader->readElementText().toInt();
 										}
 										else
 										{
@@ -740,18 +1117,111 @@ void BookmarksModel::readBookmark(QXmlStreamReader *reader, Bookmark *parent)
 				return;
 			}
 		}
+	}
+	else if (reader->name() == QLatin1String("separator"))
+	{
+		node.type = SeparatorBookmark;
+
+		reader->readNext();
+	}
+
+	nodes->append(node);
+}
+
+BookmarksModel::BookmarksTree BookmarksModel::readBookmarks(const QString &path)
+{
+	BookmarksTree tree;
+	QByteArray data;
+
+	if (QFile::exists(path))
+	{
+		QFile file(path);
+
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			tree.errorString = file.errorString();
+
+			return tree;
+		}
+
+		data = file.readAll();
+	}
+
+	tree.isOpened = true;
+	tree.checksum = createChecksum(data);
+
+	QXmlStreamReader reader(data);
+
+	if (reader.readNextStartElement() && reader.name() == QLatin1String("xbel") && reader.attributes().value(QLatin1String("version")).toString() == QLatin1String("1.0"))
+	{
+		while (reader.readNextStartElement())
+		{
+			if (reader.name() == QLatin1String("folder") || reader.name() == QLatin1String("bookmark") || reader.name() == QLatin1String("separator"))
+			{
+				readBookmark(&reader, &tree.bookmarks);
+			}
+			else
+			{
+				reader.skipCurrentElement();
+			}
+
+			if (reader.hasError())
+			{
+				tree.bookmarks.clear();
+				tree.errorString = reader.errorString();
+
+				return tree;
+			}
+		}
+	}
+
+	QFile journalFile(path + QLatin1String(".journal"));
+
+	if (!journalFile.open(QIODevice::ReadOnly))
+	{
+		return tree;
+	}
+
+	bool isMatching(QJsonDocument::fromJson(journalFile.readLine()).object().value(QLatin1String("checksum")).toString().toLatin1() == tree.checksum);
+
+	while (!journalFile.atEnd())
+	{
+		const QByteArray line(journalFile.readLine());
+		QJsonParseError error;
+		const QJsonDocument document(QJsonDocument::fromJson(line, &error));
+
+		if (error.error != QJsonParseError::NoError || !document.isObject() || !line.endsWith('\n'))
+		{
+			tree.isJournalDamaged = true;
+
+			break;
+		}
 
-		if (isFeed)
+		const QJsonObject object(document.object());
+
+		// Marks the point covered by snapshot, if it was committed only entries past it are still needed
+		if (object.value(QLatin1String("operation")).toString() == QLatin1String("snapshot"))
 		{
-			setupFeed(bookmark);
+			if (object.value(QLatin1String("checksum")).toString().toLatin1() == tree.checksum)
+			{
+				tree.journal.clear();
+
+				isMatching = true;
+			}
+
+			continue;
 		}
+
+		tree.journal.append(object);
 	}
-	else if (reader->name() == QLatin1String("separator"))
-	{
-		addBookmark(SeparatorBookmark, {}, parent);
 
-		reader->readNext();
+	if (!isMatching)
+	{
+		tree.journal.clear();
+		tree.isJournalOutdated = true;
 	}
+
+	return tree;
 }
 
 void BookmarksModel::writeBookmark(QXmlStreamWriter *writer, Bookmark *bookmark) const
@@ -876,6 +1346,24 @@ void BookmarksModel::writeBookmark(QXmlStreamWriter *writer, Bookmark *bookmark)
 	}
 }
 
+void BookmarksModel::writeBookmarks(QIODevice *device) const
+{
+	QXmlStreamWriter writer(device);
+	writer.setAutoFormatting(true);
+	writer.setAutoFormattingIndent(-1);
+	writer.writeStartDocument();
+	writer.writeDTD(QLatin1String("<!DOCTYPE xbel>"));
+	writer.writeStartElement(QLatin1String("xbel"));
+	writer.writeAttribute(QLatin1String("version"), QLatin1String("1.0"));
+
+	for (int i = 0; i < m_rootItem->rowCount(); ++i)
+	{
+		writeBookmark(&writer, m_rootItem->getChild(i));
+	}
+
+	writer.writeEndDocument();
+}
+
 void BookmarksModel::removeBookmarkUrl(Bookmark *bookmark)
 {
 	if (!bookmark)
@@ -888,17 +1376,7 @@ void BookmarksModel::removeBookmarkUrl(Bookmark *bookmark)
 		case FeedBookmark:
 		case UrlBookmark:
 			{
-				const QUrl url(Utils::normalizeUrl(bookmark->data(UrlRole).toUrl()));
-
-				if (!url.isEmpty() && m_urls.contains(url))
-				{
-					m_urls[url].removeAll(bookmark);
-
-					if (m_urls[url].isEmpty())
-					{
-						m_urls.remove(url);
-					}
-				}
+				removeUrl(bookmark, Utils::normalizeUrl(bookmark->data(UrlRole).toUrl()));
 			}
 
 			break;
@@ -914,6 +1392,36 @@ void BookmarksModel::removeBookmarkUrl(Bookmark *bookmark)
 	}
 }
 
+void BookmarksModel::removeBookmarkIdentifier(Bookmark *bookmark)
+{
+	if (!bookmark)
+	{
+		return;
+	}
+
+	const quint64 identifier(bookmark->data(IdentifierRole).toULongLong());
+
+	if (identifier > 0 && m_identifiers.value(identifier) == bookmark)
+	{
+		m_identifiers.remove(identifier);
+	}
+
+	const QString keyword(bookmark->getKeyword());
+
+	if (!keyword.isEmpty() && m_keywords.value(keyword) == bookmark)
+	{
+		handleKeywordChanged(bookmark, {}, keyword);
+	}
+
+	if (bookmark->getType() == FolderBookmark)
+	{
+		for (int i = 0; i < bookmark->rowCount(); ++i)
+		{
+			removeBookmarkIdentifier(bookmark->getChild(i));
+		}
+	}
+}
+
 void BookmarksModel::readdBookmarkUrl(Bookmark *bookmark)
 {
 	if (!bookmark)
@@ -930,12 +1438,7 @@ void BookmarksModel::readdBookmarkUrl(Bookmark *bookmark)
 
 				if (!url.isEmpty())
 				{
-					if (!m_urls.contains(url))
-					{
-						m_urls[url] = {};
-					}
-
-					m_urls[url].append(bookmark);
+					addUrl(bookmark, url);
 				}
 			}
 
@@ -1034,39 +1537,71 @@ void BookmarksModel::handleFeedModified(Feed *feed)
 	emit modelModified();
 }
 
+void BookmarksModel::addUrl(Bookmark *bookmark, const QUrl &url)
+{
+	if (!m_urls.contains(url))
+	{
+		m_urls[url] = {};
+
+		const QStringList matches(createUrlMatches(url));
+
+		for (const QString &match: matches)
+		{
+			m_urlMatches.insert(match.toLower(), url);
+		}
+	}
+
+	m_urls[url].append(bookmark);
+}
+
+void BookmarksModel::removeUrl(Bookmark *bookmark, const QUrl &url)
+{
+	if (url.isEmpty() || !m_urls.contains(url))
+	{
+		return;
+	}
+
+	m_urls[url].removeAll(bookmark);
+
+	if (m_urls[url].isEmpty())
+	{
+		m_urls.remove(url);
+
+		const QStringList matches(createUrlMatches(url));
+
+		for (const QString &match: matches)
+		{
+			m_urlMatches.remove(match.toLower(), url);
+		}
+	}
+}
+
 void BookmarksModel::handleKeywordChanged(Bookmark *bookmark, const QString &newKeyword, const QString &oldKeyword)
 {
 	if (!oldKeyword.isEmpty() && m_keywords.contains(oldKeyword))
 	{
 		m_keywords.remove(oldKeyword);
+		m_keywordMatches.remove(oldKeyword.toLower(), oldKeyword);
 	}
 
 	if (!newKeyword.isEmpty())
 	{
+		if (!m_keywords.contains(newKeyword))
+		{
+			m_keywordMatches.insert(newKeyword.toLower(), newKeyword);
+		}
+
 		m_keywords[newKeyword] = bookmark;
 	}
 }
 
 void BookmarksModel::handleUrlChanged(Bookmark *bookmark, const QUrl &newUrl, const QUrl &oldUrl)
 {
-	if (!oldUrl.isEmpty() && m_urls.contains(oldUrl))
-	{
-		m_urls[oldUrl].removeAll(bookmark);
-
-		if (m_urls[oldUrl].isEmpty())
-		{
-			m_urls.remove(oldUrl);
-		}
-	}
+	removeUrl(bookmark, oldUrl);
 
 	if (!newUrl.isEmpty())
 	{
-		if (!m_urls.contains(newUrl))
-		{
-			m_urls[newUrl] = {};
-		}
-
-		m_urls[newUrl].append(bookmark);
+		addUrl(bookmark, newUrl);
 	}
 }
 
@@ -1142,6 +1677,11 @@ BookmarksModel::Bookmark* BookmarksModel::addBookmark(BookmarkType type, const Q
 
 	bookmark->setItemData(type, TypeRole);
 
+	if (!isTrashed(parent))
+	{
+		appendJournal({{QLatin1String("operation"), QLatin1String("add")}, {QLatin1String("parent"), static_cast<qint64>(parent->getIdentifier())}, {QLatin1String("row"), bookmark->row()}, {QLatin1String("bookmark"), createJournalNode(bookmark)}});
+	}
+
 	emit bookmarkAdded(bookmark);
 	emit modelModified();
 
@@ -1284,6 +1824,78 @@ QDateTime BookmarksModel::readDateTime(QXmlStreamReader *reader, const QString &
 	return dateTime;
 }
 
+BookmarksModel::BookmarkNode BookmarksModel::readJournalNode(const QJsonObject &object)
+{
+	BookmarkNode node;
+	node.type = static_cast<BookmarkType>(object.value(QLatin1String("type")).toInt());
+
+	if (node.type == SeparatorBookmark)
+	{
+		return node;
+	}
+
+	node.metaData = {{IdentifierRole, object.value(QLatin1String("identifier")).toVariant().toULongLong()}, {TimeAddedRole, readJournalValue(object.value(getJournalKey(TimeAddedRole)), TimeAddedRole)}, {TimeModifiedRole, readJournalValue(object.value(getJournalKey(TimeModifiedRole)), TimeModifiedRole)}};
+
+	for (int i = TitleRole; i < UserRole; ++i)
+	{
+		const QString key(getJournalKey(i));
+
+		if (key.isEmpty() || !object.contains(key))
+		{
+			continue;
+		}
+
+		switch (i)
+		{
+			case TimeAddedRole:
+			case TimeModifiedRole:
+				break;
+			case UrlRole:
+			case TimeVisitedRole:
+				node.metaData[i] = readJournalValue(object.value(key), i);
+
+				break;
+			default:
+				node.itemData[i] = readJournalValue(object.value(key), i);
+
+				break;
+		}
+	}
+
+	const QJsonArray childrenArray(object.value(QLatin1String("children")).toArray());
+
+	node.children.reserve(childrenArray.count());
+
+	for (int i = 0; i < childrenArray.count(); ++i)
+	{
+		node.children.append(readJournalNode(childrenArray.at(i).toObject()));
+	}
+
+	return node;
+}
+
+QVariant BookmarksModel::readJournalValue(const QJsonValue &value, int role)
+{
+	switch (role)
+	{
+		case TimeAddedRole:
+		case TimeModifiedRole:
+		case TimeVisitedRole:
+			{
+				QDateTime dateTime(QDateTime::fromString(value.toString(), Qt::ISODate));
+				dateTime.setTimeZone(QTimeZone::utc());
+
+				return dateTime;
+			}
+		case VisitsRole:
+			return value.toInt();
+		default:
+			break;
+	}
+
+	return value.toString();
+}
+
 QStringList BookmarksModel::mimeTypes() const
 {
 	return {QLatin1String("text/uri-list")};
@@ -1294,28 +1906,138 @@ QStringList BookmarksModel::getKeywords() const
 	return m_keywords.keys();
 }
 
+QJsonObject BookmarksModel::createJournalNode(Bookmark *bookmark)
+{
+	const BookmarkType type(bookmark->getType());
+	QJsonObject object({{QLatin1String("type"), static_cast<int>(type)}});
+
+	if (type == SeparatorBookmark)
+	{
+		return object;
+	}
+
+	object.insert(QLatin1String("identifier"), static_cast<qint64>(bookmark->getIdentifier()));
+
+	for (int i = TitleRole; i < UserRole; ++i)
+	{
+		const QString key(getJournalKey(i));
+		const QVariant value(bookmark->getRawData(i));
+
+		if (!key.isEmpty() && value.isValid())
+		{
+			object.insert(key, createJournalValue(value, i));
+		}
+	}
+
+	if (type == FolderBookmark && bookmark->rowCount() > 0)
+	{
+		QJsonArray childrenArray;
+
+		for (int i = 0; i < bookmark->rowCount(); ++i)
+		{
+			Bookmark *childBookmark(bookmark->getChild(i));
+
+			if (childBookmark)
+			{
+				childrenArray.append(createJournalNode(childBookmark));
+			}
+		}
+
+		object.insert(QLatin1String("children"), childrenArray);
+	}
+
+	return object;
+}
+
+QJsonValue BookmarksModel::createJournalValue(const QVariant &value, int role)
+{
+	switch (role)
+	{
+		case TimeAddedRole:
+		case TimeModifiedRole:
+		case TimeVisitedRole:
+			return value.toDateTime().toString(Qt::ISODate);
+		case VisitsRole:
+			return value.toInt();
+		default:
+			break;
+	}
+
+	return value.toString();
+}
+
+QString BookmarksModel::getJournalKey(int role)
+{
+	switch (role)
+	{
+		case TitleRole:
+			return QLatin1String("title");
+		case UrlRole:
+			return QLatin1String("url");
+		case DescriptionRole:
+			return QLatin1String("description");
+		case KeywordRole:
+			return QLatin1String("keyword");
+		case TimeAddedRole:
+			return QLatin1String("added");
+		case TimeModifiedRole:
+			return QLatin1String("modified");
+		case TimeVisitedRole:
+			return QLatin1String("visited");
+		case VisitsRole:
+			return QLatin1String("visits");
+		default:
+			break;
+	}
+
+	return {};
+}
+
+QStringList BookmarksModel::createUrlMatches(const QUrl &url)
+{
+	QStringList matches({url.toString()});
+	const QString match(url.toString(QUrl::RemoveScheme).mid(2));
+
+	matches.append(match);
+
+	if (match.startsWith(QLatin1String("www.")) && url.host().count(QLatin1Char('.')) > 1)
+	{
+		matches.append(match.mid(4));
+	}
+
+	return matches;
+}
+
+QByteArray BookmarksModel::createChecksum(const QByteArray &data)
+{
+	return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
 QVector<BookmarksModel::BookmarkMatch> BookmarksModel::findBookmarks(const QString &prefix) const
 {
-	QVector<Bookmark*> matchedBookmarks;
+	const QString normalizedPrefix(prefix.toLower());
+	QSet<Bookmark*> matchedBookmarks;
 	QVector<BookmarkMatch> allMatches;
 	QVector<BookmarkMatch> currentMatches;
 	QMultiMap<QDateTime, BookmarkMatch> matchesMap;
-	QHash<QString, Bookmark*>::const_iterator keywordsIterator;
+	QMultiMap<QString, QString>::const_iterator keywordsIterator(m_keywordMatches.lowerBound(normalizedPrefix));
 
-	for (keywordsIterator = m_keywords.constBegin(); keywordsIterator != m_keywords.constEnd(); ++keywordsIterator)
+	for (; keywordsIterator != m_keywordMatches.constEnd() && keywordsIterator.key().startsWith(normalizedPrefix); ++keywordsIterator)
 	{
-		if (!keywordsIterator.key().startsWith(prefix, Qt::CaseInsensitive))
+		Bookmark *bookmark(m_keywords.value(keywordsIterator.value()));
+
+		if (!bookmark || !keywordsIterator.value().startsWith(prefix, Qt::CaseInsensitive))
 		{
 			continue;
 		}
 
 		BookmarkMatch match;
-		match.bookmark = keywordsIterator.value();
-		match.match = keywordsIterator.key();
+		match.bookmark = bookmark;
+		match.match = keywordsIterator.value();
 
 		matchesMap.insert(match.bookmark->getTimeVisited(), match);
 
-		matchedBookmarks.append(match.bookmark);
+		matchedBookmarks.insert(match.bookmark);
 	}
 
 	currentMatches = matchesMap.values().toVector();
@@ -1329,26 +2051,28 @@ QVector<BookmarksModel::BookmarkMatch> BookmarksModel::findBookmarks(const QStri
 		allMatches.append(currentMatches.at(i));
 	}
 
-	QHash<QUrl, QVector<Bookmark*> >::const_iterator urlsIterator;
+	QMultiMap<QString, QUrl>::const_iterator urlsIterator(m_urlMatches.lowerBound(normalizedPrefix));
 
-	for (urlsIterator = m_urls.constBegin(); urlsIterator != m_urls.constEnd(); ++urlsIterator)
+	for (; urlsIterator != m_urlMatches.constEnd() && urlsIterator.key().startsWith(normalizedPrefix); ++urlsIterator)
 	{
-		if (urlsIterator.value().isEmpty() || matchedBookmarks.contains(urlsIterator.value().value(0)))
+		const QVector<Bookmark*> bookmarks(m_urls.value(urlsIterator.value()));
+
+		if (bookmarks.isEmpty() || matchedBookmarks.contains(bookmarks.at(0)))
 		{
 			continue;
 		}
 
-		const QString result(Utils::matchUrl(urlsIterator.key(), prefix));
+		const QString result(Utils::matchUrl(urlsIterator.value(), prefix));
 
 		if (!result.isEmpty())
 		{
 			BookmarkMatch match;
-			match.bookmark = urlsIterator.value().value(0);
+			match.bookmark = bookmarks.at(0);
 			match.match = result;
 
 			matchesMap.insert(match.bookmark->getTimeVisited(), match);
 
-			matchedBookmarks.append(match.bookmark);
+			matchedBookmarks.insert(match.bookmark);
 		}
 	}
 
@@ -1452,6 +2176,11 @@ bool BookmarksModel::moveBookmark(Bookmark *bookmark, Bookmark *newParent, int n
 			newParent->insertRow(newRow, bookmark);
 		}
 
+		if (!isTrashed(newParent))
+		{
+			appendJournal({{QLatin1String("operation"), QLatin1String("add")}, {QLatin1String("parent"), static_cast<qint64>(newParent->getIdentifier())}, {QLatin1String("row"), bookmark->row()}, {QLatin1String("bookmark"), createJournalNode(bookmark)}});
+		}
+
 		emit modelModified();
 
 		return true;
@@ -1462,21 +2191,34 @@ bool BookmarksModel::moveBookmark(Bookmark *bookmark, Bookmark *newParent, int n
 	if (newRow < 0)
 	{
 		newParent->appendRow(bookmark->parent()->takeRow(bookmark->row()));
+	}
+	else
+	{
+		int targetRow(newRow);
 
-		emit bookmarkMoved(bookmark, previousParent, previousRow);
-		emit modelModified();
+		if (bookmark->parent() == newParent && bookmark->row() < newRow)
+		{
+			--targetRow;
+		}
 
-		return true;
+		newParent->insertRow(targetRow, bookmark->parent()->takeRow(bookmark->row()));
 	}
 
-	int targetRow(newRow);
+	const bool wasTrashed(isTrashed(previousParent));
+	const bool isMovedToTrash(isTrashed(newParent));
 
-	if (bookmark->parent() == newParent && bookmark->row() < newRow)
+	if (!wasTrashed && !isMovedToTrash)
 	{
-		--targetRow;
+		appendJournal({{QLatin1String("operation"), QLatin1String("move")}, {QLatin1String("parent"), static_cast<qint64>(previousParent->getIdentifier())}, {QLatin1String("row"), previousRow}, {QLatin1String("newParent"), static_cast<qint64>(newParent->getIdentifier())}, {QLatin1String("newRow"), bookmark->row()}});
+	}
+	else if (!wasTrashed)
+	{
+		appendJournal({{QLatin1String("operation"), QLatin1String("trash")}, {QLatin1String("parent"), static_cast<qint64>(previousParent->getIdentifier())}, {QLatin1String("row"), previousRow}});
+	}
+	else if (!isMovedToTrash)
+	{
+		appendJournal({{QLatin1String("operation"), QLatin1String("add")}, {QLatin1String("parent"), static_cast<qint64>(newParent->getIdentifier())}, {QLatin1String("row"), bookmark->row()}, {QLatin1String("bookmark"), createJournalNode(bookmark)}});
 	}
-
-	newParent->insertRow(targetRow, bookmark->parent()->takeRow(bookmark->row()));
 
 	emit bookmarkMoved(bookmark, previousParent, previousRow);
 	emit modelModified();
@@ -1530,7 +2272,7 @@ bool BookmarksModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
 
 bool BookmarksModel::save(const QString &path) const
 {
-	if (SessionsManager::isReadOnly())
+	if (m_isLoading || SessionsManager::isReadOnly())
 	{
 		return false;
 	}
@@ -1542,20 +2284,7 @@ bool BookmarksModel::save(const QString &path) const
 		return false;
 	}
 
-	QXmlStreamWriter writer(&file);
-	writer.setAutoFormatting(true);
-	writer.setAutoFormattingIndent(-1);
-	writer.writeStartDocument();
-	writer.writeDTD(QLatin1String("<!DOCTYPE xbel>"));
-	writer.writeStartElement(QLatin1String("xbel"));
-	writer.writeAttribute(QLatin1String("version"), QLatin1String("1.0"));
-
-	for (int i = 0; i < m_rootItem->rowCount(); ++i)
-	{
-		writeBookmark(&writer, m_rootItem->getChild(i));
-	}
-
-	writer.writeEndDocument();
+	writeBookmarks(&file);
 
 	return file.commit();
 }
@@ -1610,6 +2339,11 @@ bool BookmarksModel::setData(const QModelIndex &index, const QVariant &value, in
 
 	bookmark->setItemData(value, role);
 
+	if (bookmark->getIdentifier() > 0 && bookmark->getType() != UnknownBookmark && !getJournalKey(role).isEmpty() && !isTrashed(bookmark))
+	{
+		appendJournal({{QLatin1String("operation"), QLatin1String("modify")}, {QLatin1String("identifier"), static_cast<qint64>(bookmark->getIdentifier())}, {QLatin1String("data"), QJsonObject({{getJournalKey(role), createJournalValue(value, role)}})}});
+	}
+
 	switch (role)
 	{
 		case TitleRole:
@@ -1648,4 +2382,14 @@ bool BookmarksModel::hasKeyword(const QString &keyword) const
 	return m_keywords.contains(keyword);
 }
 
+bool BookmarksModel::isLoading() const
+{
+	return m_isLoading;
+}
+
+bool BookmarksModel::isTrashed(Bookmark *bookmark) const
+{
+	return (bookmark == m_trashItem || bookmark->data(IsTrashedRole).toBool());
+}
+
 }
@@ -21,6 +21,9 @@
 #ifndef OTTER_BOOKMARKSMODEL_H
 #define OTTER_BOOKMARKSMODEL_H
 
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QUrl>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QXmlStreamWriter>
@@ -114,6 +117,7 @@ public:
 
 	void beginImport(Bookmark *target, int estimatedUrlsAmount = 0, int estimatedKeywordsAmount = 0);
 	void endImport();
+	void compact(bool isAsynchronous = true);
 	void trashBookmark(Bookmark *bookmark);
 	void restoreBookmark(Bookmark *bookmark);
 	void removeBookmark(Bookmark *bookmark);
@@ -140,6 +144,7 @@ public:
 	bool hasBookmark(const QUrl &url) const;
 	bool hasFeed(const QUrl &url) const;
 	bool hasKeyword(const QString &keyword) const;
+	bool isLoading() const;
 
 public slots:
 	void emptyTrash();
@@ -151,14 +156,57 @@ protected:
 		int row = -1;
 	};
 
-	void readBookmark(QXmlStreamReader *reader, Bookmark *parent);
+	struct BookmarkNode final
+	{
+		QVector<BookmarkNode> children;
+		QMap<int, QVariant> metaData;
+		QMap<int, QVariant> itemData;
+		BookmarkType type = UnknownBookmark;
+	};
+
+	struct BookmarksTree final
+	{
+		QVector<BookmarkNode> bookmarks;
+		QVector<QJsonObject> journal;
+		QByteArray checksum;
+		QString errorString;
+		bool isOpened = false;
+		bool isJournalDamaged = false;
+		bool isJournalOutdated = false;
+	};
+
+	struct CompactionState final
+	{
+		QMutex mutex;
+		int generation = 0;
+	};
+
+	void attachBookmarks(const QVector<BookmarkNode> &nodes, Bookmark *parent, int index = 0);
+	void replayJournal(const QVector<QJsonObject> &journal);
+	void appendJournal(const QJsonObject &object);
+	void handleLoadingFinished(const BookmarksTree &tree, const QString &path);
+	void handleCompactionFinished(const QByteArray &checksum, qint64 offset, bool isSuccess);
 	void writeBookmark(QXmlStreamWriter *writer, Bookmark *bookmark) const;
+	void writeBookmarks(QIODevice *device) const;
 	void removeBookmarkUrl(Bookmark *bookmark);
+	void removeBookmarkIdentifier(Bookmark *bookmark);
 	void readdBookmarkUrl(Bookmark *bookmark);
+	void addUrl(Bookmark *bookmark, const QUrl &url);
+	void removeUrl(Bookmark *bookmark, const QUrl &url);
 	void setupFeed(Bookmark *bookmark);
 	void handleKeywordChanged(Bookmark *bookmark, const QString &newKeyword, const QString &oldKeyword = {});
 	void handleUrlChanged(Bookmark *bookmark, const QUrl &newUrl, const QUrl &oldUrl = {});
+	static void readBookmark(QXmlStreamReader *reader, QVector<BookmarkNode> *nodes);
+	static BookmarksTree readBookmarks(const QString &path);
 	static QDateTime readDateTime(QXmlStreamReader *reader, const QString &attribute);
+	static BookmarkNode readJournalNode(const QJsonObject &object);
+	static QVariant readJournalValue(const QJsonValue &value, int role);
+	static QJsonObject createJournalNode(Bookmark *bookmark);
+	static QJsonValue createJournalValue(const QVariant &value, int role);
+	static QString getJournalKey(int role);
+	static QStringList createUrlMatches(const QUrl &url);
+	static QByteArray createChecksum(const QByteArray &data);
+	bool isTrashed(Bookmark *bookmark) const;
 
 protected slots:
 	void handleFeedModified(Feed *feed);
@@ -172,8 +220,17 @@ private:
 	QHash<QUrl, QVector<Bookmark*> > m_feeds;
 	QHash<QUrl, QVector<Bookmark*> > m_urls;
 	QHash<QString, Bookmark*> m_keywords;
+	QMultiMap<QString, QUrl> m_urlMatches;
+	QMultiMap<QString, QString> m_keywordMatches;
 	QMap<quint64, Bookmark*> m_identifiers;
+	QSharedPointer<CompactionState> m_compactionState;
+	QString m_path;
+	QByteArray m_checksum;
 	FormatMode m_mode;
+	int m_journalEntries;
+	bool m_isLoading;
+	bool m_isCompacting;
+	bool m_needsCompaction;
 
 signals:
 	void bookmarkAdded(Bookmark *bookmark);
@@ -183,6 +240,7 @@ signals:
 	void bookmarkRestored(Bookmark *bookmark);
 	void bookmarkRemoved(Bookmark *bookmark, Bookmark *previousParent);
 	void modelModified();
+	void loadingFinished();
 
 friend class Bookmark;
 };
@@ -24,9 +24,14 @@
 
 #include <QtCore/QDataStream>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QPointer>
 #include <QtCore/QSaveFile>
+#include <QtCore/QThreadPool>
 #include <QtCore/QTimerEvent>
 
+#include <algorithm>
+
 namespace Otter
 {
 
@@ -34,9 +39,88 @@ CookieJar::CookieJar(QObject *parent) : QNetworkCookieJar(parent)
 {
 }
 
+void CookieJar::setCookies(const QList<QNetworkCookie> &cookies)
+{
+	setAllCookies(cookies);
+
+	m_domainCookies.clear();
+
+	for (const QNetworkCookie &cookie: cookies)
+	{
+		m_domainCookies[getDomainKey(cookie.domain())].append(cookie);
+	}
+}
+
+QNetworkCookie CookieJar::findCookie(const QNetworkCookie &cookie) const
+{
+	const QVector<QNetworkCookie> domainCookies(m_domainCookies.value(getDomainKey(cookie.domain())));
+
+	for (const QNetworkCookie &otherCookie: domainCookies)
+	{
+		if (cookie.hasSameIdentifier(otherCookie))
+		{
+			return otherCookie;
+		}
+	}
+
+	return {};
+}
+
+QString CookieJar::getDomainKey(const QString &domain)
+{
+	return (domain.startsWith(QLatin1Char('.')) ? domain.mid(1) : domain);
+}
+
 QList<QNetworkCookie> CookieJar::getCookiesForUrl(const QUrl &url) const
 {
-	return QNetworkCookieJar::cookiesForUrl(url);
+	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	const QString host(url.host());
+	const QString path(url.path());
+	const bool isEncrypted(url.scheme() == QLatin1String("https") || url.scheme() == QLatin1String("wss"));
+	QList<QNetworkCookie> cookies;
+	QString domain(host);
+
+	while (!domain.isEmpty())
+	{
+		const QVector<QNetworkCookie> domainCookies(m_domainCookies.value(domain));
+
+		for (const QNetworkCookie &cookie: domainCookies)
+		{
+			const QString cookieDomain(cookie.domain());
+
+			if (cookieDomain.startsWith(QLatin1Char('.')) ? !(host.endsWith(cookieDomain) || host == domain) : (host != cookieDomain))
+			{
+				continue;
+			}
+
+			const QString cookiePath(cookie.path());
+
+			if (!((path.isEmpty() && cookiePath == QLatin1String("/")) || (path.startsWith(cookiePath) && (path.length() == cookiePath.length() || cookiePath.endsWith(QLatin1Char('/')) || path.at(cookiePath.length()) == QLatin1Char('/')))))
+			{
+				continue;
+			}
+
+			if ((!cookie.isSessionCookie() && cookie.expirationDate() < currentDateTime) || (cookie.isSecure() && !isEncrypted) || (!domain.contains(QLatin1Char('.')) && host != domain))
+			{
+				continue;
+			}
+
+			int position(0);
+
+			while (position < cookies.count() && cookies.at(position).path().length() >= cookiePath.length())
+			{
+				++position;
+			}
+
+			cookies.insert(position, cookie);
+		}
+
+		const int position(domain.indexOf(QLatin1Char('.')));
+
+		domain = ((position < 0) ? QString() : domain.mid(position + 1));
+	}
+
+	return cookies;
 }
 
 QVector<QNetworkCookie> CookieJar::getCookies(const QString &domain) const
@@ -46,32 +130,79 @@ QVector<QNetworkCookie> CookieJar::getCookies(const QString &domain) const
 		return allCookies().toVector();
 	}
 
-	const QList<QNetworkCookie> cookies(allCookies());
-	QVector<QNetworkCookie> domainCookies;
+	QVector<QNetworkCookie> cookies;
+	QString parentDomain(domain);
 
-	for (const QNetworkCookie &cookie: cookies)
+	while (!parentDomain.isEmpty())
 	{
-		if (cookie.domain() == domain || (cookie.domain().startsWith(QLatin1Char('.')) && domain.endsWith(cookie.domain())))
+		const QVector<QNetworkCookie> domainCookies(m_domainCookies.value(parentDomain));
+
+		for (const QNetworkCookie &cookie: domainCookies)
 		{
-			domainCookies.append(cookie);
+			if (cookie.domain() == domain || (cookie.domain().startsWith(QLatin1Char('.')) && domain.endsWith(cookie.domain())))
+			{
+				cookies.append(cookie);
+			}
 		}
+
+		const int position(parentDomain.indexOf(QLatin1Char('.')));
+
+		parentDomain = ((position < 0) ? QString() : parentDomain.mid(position + 1));
 	}
 
-	return domainCookies;
+	return cookies;
 }
 
-bool CookieJar::hasCookie(const QNetworkCookie &cookie) const
+bool CookieJar::insertCookie(const QNetworkCookie &cookie)
 {
-	QUrl url;
-	url.setScheme(cookie.isSecure() ? QLatin1String("https") : QLatin1String("http"));
-	url.setHost(cookie.domain().startsWith(QLatin1Char('.')) ? cookie.domain().mid(1) : cookie.domain());
-	url.setPath(cookie.path());
+	if (!QNetworkCookieJar::insertCookie(cookie))
+	{
+		return false;
+	}
+
+	m_domainCookies[getDomainKey(cookie.domain())].append(cookie);
 
-	const QList<QNetworkCookie> cookies(getCookiesForUrl(url));
+	return true;
+}
 
-	for (const QNetworkCookie &otherCookie: cookies)
+bool CookieJar::deleteCookie(const QNetworkCookie &cookie)
+{
+	if (!QNetworkCookieJar::deleteCookie(cookie))
 	{
-		if (cookie.hasSameIdentifier(otherCookie))
+		return false;
+	}
+
+	const QHash<QString, QVector<QNetworkCookie> >::iterator iterator(m_domainCookies.find(getDomainKey(cookie.domain())));
+
+	if (iterator != m_domainCookies.end())
+	{
+		for (int i = 0; i < iterator.value().count(); ++i)
+		{
+			if (iterator.value().at(i).hasSameIdentifier(cookie))
+			{
+				iterator.value().removeAt(i);
+
+				break;
+			}
+		}
+
+		if (iterator.value().isEmpty())
+		{
+			m_domainCookies.erase(iterator);
+		}
+	}
+
+	return true;
+}
+
+bool CookieJar::hasCookie(const QNetworkCookie &cookie) const
+{
+	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	const QVector<QNetworkCookie> domainCookies(m_domainCookies.value(getDomainKey(cookie.domain())));
+
+	for (const QNetworkCookie &otherCookie: domainCookies)
+	{
+		if (cookie.hasSameIdentifier(otherCookie) && (otherCookie.isSessionCookie() || otherCookie.expirationDate() >= currentDateTime))
 		{
 			return true;
 		}
@@ -82,10 +213,16 @@ bool CookieJar::hasCookie(const QNetworkCookie &cookie) const
 
 DiskCookieJar::DiskCookieJar(const QString &path, QObject *parent) : CookieJar(parent),
 	m_path(path),
+	m_snapshotState(new SnapshotState()),
 	m_generalCookiesPolicy(AcceptAllCookies),
 	m_thirdPartyCookiesPolicy(AcceptAllCookies),
 	m_keepMode(KeepUntilExpiresMode),
-	m_saveTimer(0)
+	m_expirationTime(0),
+	m_loggedRecords(0),
+	m_expirationTimer(0),
+	m_saveTimer(0),
+	m_isCompacting(false),
+	m_needsCompaction(false)
 {
 	if (!path.isEmpty())
 	{
@@ -95,59 +232,126 @@ DiskCookieJar::DiskCookieJar(const QString &path, QObject *parent) : CookieJar(p
 	handleOptionChanged(SettingsManager::Network_CookiesPolicyOption, SettingsManager::getOption(SettingsManager::Network_CookiesPolicyOption));
 
 	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &DiskCookieJar::handleOptionChanged);
+	connect(Application::getInstance(), &Application::aboutToQuit, this, [&]()
+	{
+		if (m_saveTimer != 0 || m_needsCompaction)
+		{
+			scheduleSave();
+		}
+	});
 }
 
 void DiskCookieJar::timerEvent(QTimerEvent *event)
 {
-	if (event->timerId() != m_saveTimer)
+	if (event->timerId() == m_saveTimer)
 	{
-		return;
-	}
+		killTimer(m_saveTimer);
 
-	killTimer(m_saveTimer);
+		m_saveTimer = 0;
 
-	m_saveTimer = 0;
+		save();
+	}
+	else if (event->timerId() == m_expirationTimer)
+	{
+		killTimer(m_expirationTimer);
 
-	save();
+		m_expirationTimer = 0;
+
+		expireCookies();
+	}
 }
 
 void DiskCookieJar::loadCookies(const QString &path)
 {
-	QFile file(path);
+	QHash<QByteArray, QNetworkCookie> cookies;
 
-	if (!file.open(QIODevice::ReadOnly))
+	if (readRecords(path, cookies) < 0)
 	{
-		return;
-	}
+		QFile file(path);
 
-	QDataStream stream(&file);
-	quint32 amount;
+		if (file.open(QIODevice::ReadOnly))
+		{
+			QDataStream stream(&file);
+			quint32 amount;
 
-	stream >> amount;
+			stream >> amount;
 
-	QList<QNetworkCookie> allCookies;
-	allCookies.reserve(static_cast<int>(amount));
+			cookies.reserve(static_cast<int>(amount));
 
-	for (quint32 i = 0; i < amount; ++i)
-	{
-		QByteArray value;
+			for (quint32 i = 0; i < amount; ++i)
+			{
+				QByteArray value;
+
+				stream >> value;
+
+				const QList<QNetworkCookie> parsedCookies(QNetworkCookie::parseCookies(value));
+
+				for (const QNetworkCookie &cookie: parsedCookies)
+				{
+					cookies[getCookieKey(cookie)] = cookie;
+				}
+
+				if (stream.atEnd())
+				{
+					break;
+				}
+			}
+
+			m_needsCompaction = true;
+		}
+	}
 
-		stream >> value;
+	const QString logPath(getLogPath(path));
+	qint64 validSize(0);
+	const int amount(readRecords(logPath, cookies, &validSize));
 
-		const QList<QNetworkCookie> cookies(QNetworkCookie::parseCookies(value));
+	if (amount >= 0)
+	{
+		m_loggedRecords = amount;
 
-		for (const QNetworkCookie &cookie: cookies)
+		if (!SessionsManager::isReadOnly() && validSize < QFileInfo(logPath).size())
 		{
-			allCookies.append(cookie);
+			QFile::resize(logPath, validSize);
 		}
+	}
+	else if (!SessionsManager::isReadOnly() && QFile::exists(logPath))
+	{
+		QFile::remove(logPath);
+	}
 
-		if (stream.atEnd())
+	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	QList<QNetworkCookie> allCookies;
+	allCookies.reserve(cookies.count());
+
+	QHash<QByteArray, QNetworkCookie>::const_iterator iterator;
+
+	for (iterator = cookies.constBegin(); iterator != cookies.constEnd(); ++iterator)
+	{
+		if (!iterator.value().isSessionCookie() && iterator.value().expirationDate() > currentDateTime)
 		{
-			break;
+			allCookies.append(iterator.value());
 		}
 	}
 
-	setAllCookies(allCookies);
+	setCookies(allCookies);
+	rebuildExpirations();
+}
+
+void DiskCookieJar::addRecord(CookieOperation operation, const QNetworkCookie &cookie)
+{
+	if (m_path.isEmpty())
+	{
+		return;
+	}
+
+	QDataStream stream(&m_pendingRecords, QIODevice::Append);
+	stream.setVersion(QDataStream::Qt_5_15);
+
+	writeRecord(stream, ((operation != RemoveCookie && cookie.isSessionCookie()) ? RemoveCookie : operation), cookie);
+
+	++m_loggedRecords;
+
+	scheduleSave();
 }
 
 void DiskCookieJar::clearCookies(int period)
@@ -156,14 +360,139 @@ void DiskCookieJar::clearCookies(int period)
 
 	const QList<QNetworkCookie> cookies(allCookies());
 
-	setAllCookies({});
+	setCookies({});
 
 	for (const QNetworkCookie &cookie: cookies)
 	{
 		emit cookieRemoved(cookie);
 	}
 
-	scheduleSave();
+	m_pendingRecords.clear();
+	m_expirations.clear();
+
+	scheduleExpiration();
+
+	if (m_path.isEmpty())
+	{
+		return;
+	}
+
+	QDataStream stream(&m_pendingRecords, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << static_cast<quint8>(ClearRecord);
+
+	m_needsCompaction = true;
+
+	if (m_saveTimer != 0)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+	}
+
+	save();
+}
+
+void DiskCookieJar::addExpiration(const QNetworkCookie &cookie)
+{
+	if (cookie.isSessionCookie())
+	{
+		return;
+	}
+
+	if (m_expirations.count() > ((allCookies().count() * 2) + 1000))
+	{
+		rebuildExpirations();
+
+		return;
+	}
+
+	ExpirationEntry entry;
+	entry.cookie = cookie;
+	entry.expirationTime = cookie.expirationDate().toMSecsSinceEpoch();
+
+	m_expirations.append(entry);
+
+	std::push_heap(m_expirations.begin(), m_expirations.end(), isExpiringLater);
+
+	scheduleExpiration();
+}
+
+void DiskCookieJar::rebuildExpirations()
+{
+	const QList<QNetworkCookie> cookies(allCookies());
+
+	m_expirations.clear();
+	m_expirations.reserve(cookies.count());
+
+	for (const QNetworkCookie &cookie: cookies)
+	{
+		if (!cookie.isSessionCookie())
+		{
+			ExpirationEntry entry;
+			entry.cookie = cookie;
+			entry.expirationTime = cookie.expirationDate().toMSecsSinceEpoch();
+
+			m_expirations.append(entry);
+		}
+	}
+
+	std::make_heap(m_expirations.begin(), m_expirations.end(), isExpiringLater);
+
+	scheduleExpiration();
+}
+
+void DiskCookieJar::scheduleExpiration()
+{
+	if (m_expirations.isEmpty())
+	{
+		if (m_expirationTimer != 0)
+		{
+			killTimer(m_expirationTimer);
+
+			m_expirationTimer = 0;
+		}
+
+		return;
+	}
+
+	const qint64 expirationTime(m_expirations.first().expirationTime);
+
+	if (m_expirationTimer != 0)
+	{
+		if (m_expirationTime <= expirationTime)
+		{
+			return;
+		}
+
+		killTimer(m_expirationTimer);
+	}
+
+	m_expirationTime = expirationTime;
+	m_expirationTimer = startTimer(static_cast<int>(qBound(qint64(0), (expirationTime - QDateTime::currentMSecsSinceEpoch()), qint64(3600000))));
+}
+
+void DiskCookieJar::expireCookies()
+{
+	const qint64 currentTime(QDateTime::currentMSecsSinceEpoch());
+	int amount(0);
+
+	while (!m_expirations.isEmpty() && m_expirations.first().expirationTime <= currentTime && amount < 500)
+	{
+		std::pop_heap(m_expirations.begin(), m_expirations.end(), isExpiringLater);
+
+		const ExpirationEntry entry(m_expirations.takeLast());
+		const QNetworkCookie cookie(findCookie(entry.cookie));
+
+		if (cookie.hasSameIdentifier(entry.cookie) && !cookie.isSessionCookie() && cookie.expirationDate().toMSecsSinceEpoch() <= currentTime && CookieJar::deleteCookie(cookie))
+		{
+			emit cookieRemoved(cookie);
+
+			++amount;
+		}
+	}
+
+	scheduleExpiration();
 }
 
 void DiskCookieJar::scheduleSave()
@@ -229,29 +558,332 @@ void DiskCookieJar::save()
 {
 	if (m_path.isEmpty() || SessionsManager::isReadOnly())
 	{
+		m_pendingRecords.clear();
+
 		return;
 	}
 
-	QSaveFile file(m_path);
+	if (!m_pendingRecords.isEmpty())
+	{
+		QFile file(getLogPath(m_path));
 
-	if (!file.open(QIODevice::WriteOnly))
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+		{
+			return;
+		}
+
+		if (file.size() == 0)
+		{
+			QDataStream stream(&file);
+			stream.setVersion(QDataStream::Qt_5_15);
+			stream << static_cast<quint32>(FileSignature) << static_cast<quint32>(FileVersion);
+		}
+
+		file.write(m_pendingRecords);
+
+		m_pendingRecords.clear();
+	}
+
+	if (!m_needsCompaction && m_loggedRecords <= qMax(1000, static_cast<int>(allCookies().count())))
 	{
 		return;
 	}
 
+	if (Application::isAboutToQuit())
+	{
+		compact(false);
+	}
+	else if (!m_isCompacting)
+	{
+		compact();
+	}
+}
+
+void DiskCookieJar::compact(bool isAsynchronous)
+{
+	const QString path(m_path);
 	const QList<QNetworkCookie> cookies(allCookies());
+
+	m_needsCompaction = false;
+	m_loggedRecords = 0;
+
+	if (!isAsynchronous)
+	{
+		QMutexLocker locker(&m_snapshotState->mutex);
+
+		++m_snapshotState->generation;
+
+		if (writeCookies(path, cookies))
+		{
+			QFile::remove(getLogPath(path));
+		}
+		else
+		{
+			m_needsCompaction = true;
+		}
+
+		return;
+	}
+
+	const QPointer<DiskCookieJar> cookieJar(this);
+	const QSharedPointer<SnapshotState> state(m_snapshotState);
+	const qint64 logSize(QFileInfo(getLogPath(m_path)).size());
+	int generation(0);
+
+	{
+		QMutexLocker locker(&state->mutex);
+
+		generation = state->generation;
+	}
+
+	m_isCompacting = true;
+
+	QThreadPool::globalInstance()->start([=]()
+	{
+		bool isSuccess(false);
+
+		{
+			QMutexLocker locker(&state->mutex);
+
+			if (state->generation == generation)
+			{
+				isSuccess = writeCookies(path, cookies);
+			}
+		}
+
+		QMetaObject::invokeMethod(QCoreApplication::instance(), [=]()
+		{
+			if (cookieJar)
+			{
+				cookieJar->handleCompactionFinished(isSuccess, logSize);
+			}
+		}, Qt::QueuedConnection);
+	});
+}
+
+void DiskCookieJar::handleCompactionFinished(bool isSuccess, qint64 logSize)
+{
+	m_isCompacting = false;
+
+	if (!isSuccess)
+	{
+		m_needsCompaction = true;
+
+		return;
+	}
+
+	if (m_needsCompaction)
+	{
+		scheduleSave();
+	}
+
+	if (logSize <= 0)
+	{
+		return;
+	}
+
+	const QString logPath(getLogPath(m_path));
+	QFile file(logPath);
+
+	if (!file.open(QIODevice::ReadOnly) || !file.seek(logSize))
+	{
+		return;
+	}
+
+	const QByteArray records(file.readAll());
+
+	file.close();
+
+	if (records.isEmpty())
+	{
+		QFile::remove(logPath);
+
+		return;
+	}
+
+	QSaveFile logFile(logPath);
+
+	if (!logFile.open(QIODevice::WriteOnly))
+	{
+		return;
+	}
+
+	QDataStream stream(&logFile);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << static_cast<quint32>(FileSignature) << static_cast<quint32>(FileVersion);
+
+	logFile.write(records);
+	logFile.commit();
+}
+
+void DiskCookieJar::writeRecord(QDataStream &stream, CookieOperation operation, const QNetworkCookie &cookie)
+{
+	stream << static_cast<quint8>(operation) << cookie.name() << cookie.domain() << cookie.path();
+
+	if (operation == RemoveCookie)
+	{
+		return;
+	}
+
+	quint8 flags(0);
+	quint8 sameSitePolicy(0);
+
+	if (cookie.isSecure())
+	{
+		flags |= 1;
+	}
+
+	if (cookie.isHttpOnly())
+	{
+		flags |= 2;
+	}
+
+#if QT_VERSION >= 0x060100
+	sameSitePolicy = static_cast<quint8>(cookie.sameSitePolicy());
+#endif
+
+	stream << cookie.value() << cookie.expirationDate().toMSecsSinceEpoch() << flags << sameSitePolicy;
+}
+
+QString DiskCookieJar::getLogPath(const QString &path)
+{
+	return path + QLatin1String(".log");
+}
+
+QByteArray DiskCookieJar::getCookieKey(const QNetworkCookie &cookie)
+{
+	return (cookie.domain().toUtf8() + '\n' + cookie.path().toUtf8() + '\n' + cookie.name());
+}
+
+int DiskCookieJar::readRecords(const QString &path, QHash<QByteArray, QNetworkCookie> &cookies, qint64 *validSize)
+{
+	QFile file(path);
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return -1;
+	}
+
 	QDataStream stream(&file);
-	stream << static_cast<quint32>(cookies.count());
+	stream.setVersion(QDataStream::Qt_5_15);
+
+	quint32 signature(0);
+	quint32 version(0);
+
+	stream >> signature >> version;
+
+	if (signature != FileSignature || version != FileVersion || stream.status() != QDataStream::Ok)
+	{
+		return -1;
+	}
+
+	qint64 position(file.pos());
+	int amount(0);
+
+	while (!stream.atEnd())
+	{
+		quint8 operation(0);
+
+		stream >> operation;
+
+		if (operation == ClearRecord)
+		{
+			if (stream.status() != QDataStream::Ok)
+			{
+				break;
+			}
+
+			cookies.clear();
+
+			position = file.pos();
+
+			++amount;
+
+			continue;
+		}
+
+		QByteArray name;
+		QString domain;
+		QString cookiePath;
+
+		stream >> name >> domain >> cookiePath;
+
+		QNetworkCookie cookie(name);
+		cookie.setDomain(domain);
+		cookie.setPath(cookiePath);
+
+		if (operation != RemoveCookie)
+		{
+			QByteArray value;
+			qint64 expirationDate(0);
+			quint8 flags(0);
+			quint8 sameSitePolicy(0);
+
+			stream >> value >> expirationDate >> flags >> sameSitePolicy;
+
+			cookie.setValue(value);
+			cookie.setExpirationDate(QDateTime::fromMSecsSinceEpoch(expirationDate).toUTC());
+			cookie.setSecure(flags & 1);
+			cookie.setHttpOnly(flags & 2);
+#if QT_VERSION >= 0x060100
+			cookie.setSameSitePolicy(static_cast<QNetworkCookie::SameSite>(sameSitePolicy));
+#endif
+		}
+
+		if (stream.status() != QDataStream::Ok)
+		{
+			break;
+		}
+
+		if (operation == RemoveCookie)
+		{
+			cookies.remove(getCookieKey(cookie));
+		}
+		else
+		{
+			cookies[getCookieKey(cookie)] = cookie;
+		}
+
+		position = file.pos();
+
+		++amount;
+	}
+
+	if (validSize)
+	{
+		*validSize = position;
+	}
+
+	return amount;
+}
+
+bool DiskCookieJar::writeCookies(const QString &path, const QList<QNetworkCookie> &cookies)
+{
+	QSaveFile file(path);
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << static_cast<quint32>(FileSignature) << static_cast<quint32>(FileVersion);
 
 	for (const QNetworkCookie &cookie: cookies)
 	{
 		if (!cookie.isSessionCookie())
 		{
-			stream << cookie.toRawForm();
+			writeRecord(stream, InsertCookie, cookie);
 		}
 	}
 
-	file.commit();
+	return file.commit();
+}
+
+bool DiskCookieJar::isExpiringLater(const ExpirationEntry &first, const ExpirationEntry &second)
+{
+	return (first.expirationTime > second.expirationTime);
 }
 
 QString DiskCookieJar::getPath() const
@@ -266,7 +898,7 @@ QList<QNetworkCookie> DiskCookieJar::cookiesForUrl(const QUrl &url) const
 		return {};
 	}
 
-	return QNetworkCookieJar::cookiesForUrl(url);
+	return getCookiesForUrl(url);
 }
 
 bool DiskCookieJar::insertCookie(const QNetworkCookie &cookie)
@@ -276,11 +908,12 @@ bool DiskCookieJar::insertCookie(const QNetworkCookie &cookie)
 		return false;
 	}
 
-	const bool result(QNetworkCookieJar::insertCookie(cookie));
+	const bool result(CookieJar::insertCookie(cookie));
 
 	if (result)
 	{
-		scheduleSave();
+		addRecord(InsertCookie, cookie);
+		addExpiration(cookie);
 
 		emit cookieAdded(cookie);
 	}
@@ -299,7 +932,8 @@ bool DiskCookieJar::updateCookie(const QNetworkCookie &cookie)
 
 	if (result)
 	{
-		scheduleSave();
+		addRecord(UpdateCookie, cookie);
+		addExpiration(cookie);
 
 		emit cookieModified(cookie);
 	}
@@ -314,11 +948,11 @@ bool DiskCookieJar::deleteCookie(const QNetworkCookie &cookie)
 		return false;
 	}
 
-	const bool result(QNetworkCookieJar::deleteCookie(cookie));
+	const bool result(CookieJar::deleteCookie(cookie));
 
 	if (result)
 	{
-		scheduleSave();
+		addRecord(RemoveCookie, cookie);
 
 		emit cookieRemoved(cookie);
 	}
@@ -328,11 +962,12 @@ bool DiskCookieJar::deleteCookie(const QNetworkCookie &cookie)
 
 bool DiskCookieJar::forceInsertCookie(const QNetworkCookie &cookie)
 {
-	const bool result(QNetworkCookieJar::insertCookie(cookie));
+	const bool result(CookieJar::insertCookie(cookie));
 
 	if (result)
 	{
-		scheduleSave();
+		addRecord(InsertCookie, cookie);
+		addExpiration(cookie);
 
 		emit cookieAdded(cookie);
 	}
@@ -346,7 +981,8 @@ bool DiskCookieJar::forceUpdateCookie(const QNetworkCookie &cookie)
 
 	if (result)
 	{
-		scheduleSave();
+		addRecord(UpdateCookie, cookie);
+		addExpiration(cookie);
 
 		emit cookieModified(cookie);
 	}
@@ -356,11 +992,11 @@ bool DiskCookieJar::forceUpdateCookie(const QNetworkCookie &cookie)
 
 bool DiskCookieJar::forceDeleteCookie(const QNetworkCookie &cookie)
 {
-	const bool result(QNetworkCookieJar::deleteCookie(cookie));
+	const bool result(CookieJar::deleteCookie(cookie));
 
 	if (result)
 	{
-		scheduleSave();
+		addRecord(RemoveCookie, cookie);
 
 		emit cookieRemoved(cookie);
 	}
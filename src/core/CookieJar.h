@@ -20,6 +20,10 @@
 #ifndef OTTER_COOKIEJAR_H
 #define OTTER_COOKIEJAR_H
 
+#include <QtCore/QDataStream>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
 #include <QtNetwork/QNetworkCookie>
 #include <QtNetwork/QNetworkCookieJar>
 
@@ -61,8 +65,18 @@ public:
 	virtual bool forceInsertCookie(const QNetworkCookie &cookie) = 0;
 	virtual bool forceUpdateCookie(const QNetworkCookie &cookie) = 0;
 	virtual bool forceDeleteCookie(const QNetworkCookie &cookie) = 0;
+	bool insertCookie(const QNetworkCookie &cookie) override;
+	bool deleteCookie(const QNetworkCookie &cookie) override;
 	bool hasCookie(const QNetworkCookie &cookie) const;
 
+protected:
+	void setCookies(const QList<QNetworkCookie> &cookies);
+	QNetworkCookie findCookie(const QNetworkCookie &cookie) const;
+	static QString getDomainKey(const QString &domain);
+
+private:
+	QHash<QString, QVector<QNetworkCookie> > m_domainCookies;
+
 signals:
 	void cookieAdded(const QNetworkCookie &cookie);
 	void cookieModified(const QNetworkCookie &cookie);
@@ -74,6 +88,13 @@ class DiskCookieJar final : public CookieJar
 	Q_OBJECT
 
 public:
+	enum
+	{
+		FileSignature = 0x4F54434B,
+		FileVersion = 1,
+		ClearRecord = 0xFF
+	};
+
 	explicit DiskCookieJar(const QString &path, QObject *parent = nullptr);
 
 	void clearCookies(int period = 0) override;
@@ -87,20 +108,53 @@ public:
 	bool forceDeleteCookie(const QNetworkCookie &cookie) override;
 
 protected:
+	struct ExpirationEntry final
+	{
+		QNetworkCookie cookie;
+		qint64 expirationTime = 0;
+	};
+
+	struct SnapshotState final
+	{
+		QMutex mutex;
+		int generation = 0;
+	};
+
 	void timerEvent(QTimerEvent *event) override;
 	void loadCookies(const QString &path);
+	void addRecord(CookieOperation operation, const QNetworkCookie &cookie);
+	void addExpiration(const QNetworkCookie &cookie);
+	void rebuildExpirations();
+	void scheduleExpiration();
+	void expireCookies();
 	void scheduleSave();
 	void save();
+	void compact(bool isAsynchronous = true);
+	void handleCompactionFinished(bool isSuccess, qint64 logSize);
+	static void writeRecord(QDataStream &stream, CookieOperation operation, const QNetworkCookie &cookie);
+	static QString getLogPath(const QString &path);
+	static QByteArray getCookieKey(const QNetworkCookie &cookie);
+	static int readRecords(const QString &path, QHash<QByteArray, QNetworkCookie> &cookies, qint64 *validSize = nullptr);
+	static bool writeCookies(const QString &path, const QList<QNetworkCookie> &cookies);
+	static bool isExpiringLater(const ExpirationEntry &first, const ExpirationEntry &second);
 
 protected slots:
 	void handleOptionChanged(int identifier, const QVariant &value);
 
 private:
 	QString m_path;
+	QByteArray m_pendingRecords;
+	QVector<ExpirationEntry> m_expirations;
+	QSharedPointer<SnapshotState> m_snapshotState;
 	CookiesPolicy m_generalCookiesPolicy;
 	CookiesPolicy m_thirdPartyCookiesPolicy;
 	KeepMode m_keepMode;
+	qint64 m_expirationTime;
+	int m_loggedRecords;
+	int m_expirationTimer;
 	int m_saveTimer;
+	bool m_isCompacting;
+	bool m_needsCompaction;
 };
 
 }
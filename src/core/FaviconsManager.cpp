@@ -0,0 +1,390 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2026 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "FaviconsManager.h"
+#include "Application.h"
+#include "BookmarksManager.h"
+#include "JsonSettings.h"
+#include "SessionsManager.h"
+#include "Utils.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTimerEvent>
+
+namespace Otter
+{
+
+FaviconsManager* FaviconsManager::m_instance(nullptr);
+QCache<QByteArray, QIcon> FaviconsManager::m_icons(500);
+QHash<QString, QByteArray> FaviconsManager::m_urls;
+QHash<QString, QByteArray> FaviconsManager::m_hosts;
+QHash<QString, qint64> FaviconsManager::m_cacheKeys;
+QHash<QByteArray, int> FaviconsManager::m_references;
+QVector<QByteArray> FaviconsManager::m_orphans;
+bool FaviconsManager::m_isInitialized(false);
+
+FaviconsManager::FaviconsManager(QObject *parent) : QObject(parent),
+	m_saveTimer(0)
+{
+}
+
+void FaviconsManager::createInstance()
+{
+	if (!m_instance)
+	{
+		m_instance = new FaviconsManager(QCoreApplication::instance());
+	}
+}
+
+void FaviconsManager::ensureInitialized()
+{
+	if (m_isInitialized)
+	{
+		return;
+	}
+
+	m_isInitialized = true;
+
+	const QJsonObject indexObject(JsonSettings(SessionsManager::getWritableDataPath(QLatin1String("favicons/index.json"))).object());
+	const QJsonObject urlsObject(indexObject.value(QLatin1String("urls")).toObject());
+	const QJsonObject hostsObject(indexObject.value(QLatin1String("hosts")).toObject());
+
+	m_urls.reserve(urlsObject.count());
+	m_hosts.reserve(hostsObject.count());
+
+	for (QJsonObject::const_iterator iterator = urlsObject.constBegin(); iterator != urlsObject.constEnd(); ++iterator)
+	{
+		const QByteArray checksum(iterator.value().toString().toLatin1());
+
+		m_urls[iterator.key()] = checksum;
+
+		addReference(checksum);
+	}
+
+	for (QJsonObject::const_iterator iterator = hostsObject.constBegin(); iterator != hostsObject.constEnd(); ++iterator)
+	{
+		const QByteArray checksum(iterator.value().toString().toLatin1());
+
+		m_hosts[iterator.key()] = checksum;
+
+		addReference(checksum);
+	}
+}
+
+void FaviconsManager::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_saveTimer)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		save();
+	}
+}
+
+void FaviconsManager::scheduleSave()
+{
+	if (Application::isAboutToQuit())
+	{
+		if (m_saveTimer != 0)
+		{
+			killTimer(m_saveTimer);
+
+			m_saveTimer = 0;
+		}
+
+		save();
+	}
+	else if (m_saveTimer == 0)
+	{
+		m_saveTimer = startTimer(1000);
+	}
+}
+
+void FaviconsManager::save()
+{
+	if (SessionsManager::isReadOnly())
+	{
+		return;
+	}
+
+	QStringList orphanPaths;
+	orphanPaths.reserve(m_orphans.count());
+
+	for (const QByteArray &checksum: std::as_const(m_orphans))
+	{
+		if (!m_references.contains(checksum))
+		{
+			orphanPaths.append(getBlobPath(checksum));
+		}
+	}
+
+	m_orphans.clear();
+
+	Utils::removeFiles(orphanPaths);
+
+	QJsonObject urlsObject;
+	QHash<QString, QByteArray>::const_iterator iterator;
+
+	for (iterator = m_urls.constBegin(); iterator != m_urls.constEnd(); ++iterator)
+	{
+		urlsObject.insert(iterator.key(), QString::fromLatin1(iterator.value()));
+	}
+
+	QJsonObject hostsObject;
+
+	for (iterator = m_hosts.constBegin(); iterator != m_hosts.constEnd(); ++iterator)
+	{
+		hostsObject.insert(iterator.key(), QString::fromLatin1(iterator.value()));
+	}
+
+	JsonSettings settings;
+	settings.setObject({{QLatin1String("urls"), urlsObject}, {QLatin1String("hosts"), hostsObject}});
+	settings.save(SessionsManager::getWritableDataPath(QLatin1String("favicons/index.json")));
+}
+
+void FaviconsManager::clearIcons()
+{
+	m_icons.clear();
+	m_urls.clear();
+	m_hosts.clear();
+	m_cacheKeys.clear();
+	m_references.clear();
+	m_orphans.clear();
+
+	m_isInitialized = true;
+
+	if (!SessionsManager::isReadOnly())
+	{
+		QDir(SessionsManager::getWritableDataPath(QLatin1String("favicons"))).removeRecursively();
+	}
+}
+
+void FaviconsManager::removeIcons(const QVector<QUrl> &urls)
+{
+	ensureInitialized();
+
+	bool hasChanges(false);
+
+	for (const QUrl &url: urls)
+	{
+		if (BookmarksManager::hasBookmark(url))
+		{
+			continue;
+		}
+
+		const QString urlKey(Utils::normalizeUrl(url).toString());
+
+		m_cacheKeys.remove(urlKey);
+
+		if (m_urls.contains(urlKey))
+		{
+			removeReference(m_urls.take(urlKey));
+
+			hasChanges = true;
+		}
+	}
+
+	if (hasChanges && m_instance)
+	{
+		m_instance->scheduleSave();
+	}
+}
+
+void FaviconsManager::addReference(const QByteArray &checksum)
+{
+	if (!checksum.isEmpty())
+	{
+		m_references[checksum] = (m_references.value(checksum, 0) + 1);
+	}
+}
+
+void FaviconsManager::removeReference(const QByteArray &checksum)
+{
+	if (checksum.isEmpty() || !m_references.contains(checksum))
+	{
+		return;
+	}
+
+	--m_references[checksum];
+
+	if (m_references[checksum] <= 0)
+	{
+		m_references.remove(checksum);
+		m_icons.remove(checksum);
+		m_orphans.append(checksum);
+	}
+}
+
+void FaviconsManager::setIcon(const QUrl &url, const QIcon &icon)
+{
+	if (icon.isNull() || !url.isValid() || Utils::isUrlEmpty(url))
+	{
+		return;
+	}
+
+	ensureInitialized();
+
+	const QString urlKey(Utils::normalizeUrl(url).toString());
+
+	if (m_urls.contains(urlKey) && m_cacheKeys.value(urlKey) == icon.cacheKey())
+	{
+		return;
+	}
+
+	const QList<QSize> sizes(icon.availableSizes());
+	QSize size(16, 16);
+
+	for (const QSize &availableSize: sizes)
+	{
+		if (availableSize.width() > size.width() && availableSize.width() <= 64)
+		{
+			size = availableSize;
+		}
+	}
+
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+
+	if (!icon.pixmap(size).save(&buffer, "PNG"))
+	{
+		return;
+	}
+
+	const QByteArray checksum(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+	const QString host(Utils::extractHost(url));
+	const QByteArray previousUrlChecksum(m_urls.value(urlKey));
+	const QByteArray previousHostChecksum(m_hosts.value(host));
+
+	m_cacheKeys[urlKey] = icon.cacheKey();
+
+	if (previousUrlChecksum == checksum && (host.isEmpty() || previousHostChecksum == checksum))
+	{
+		return;
+	}
+
+	if (!m_references.contains(checksum))
+	{
+		m_orphans.removeAll(checksum);
+
+		if (!SessionsManager::isReadOnly() && Utils::ensureDirectoryExists(SessionsManager::getWritableDataPath(QLatin1String("favicons"))))
+		{
+			QSaveFile file(getBlobPath(checksum));
+
+			if (file.open(QIODevice::WriteOnly))
+			{
+				file.write(data);
+				file.commit();
+			}
+		}
+	}
+
+	if (!m_icons.contains(checksum))
+	{
+		m_icons.insert(checksum, new QIcon(icon));
+	}
+
+	if (previousUrlChecksum != checksum)
+	{
+		addReference(checksum);
+		removeReference(previousUrlChecksum);
+
+		m_urls[urlKey] = checksum;
+	}
+
+	if (!host.isEmpty() && previousHostChecksum != checksum)
+	{
+		addReference(checksum);
+		removeReference(previousHostChecksum);
+
+		m_hosts[host] = checksum;
+	}
+
+	if (m_instance)
+	{
+		m_instance->scheduleSave();
+	}
+}
+
+FaviconsManager* FaviconsManager::getInstance()
+{
+	return m_instance;
+}
+
+QString FaviconsManager::getBlobPath(const QByteArray &checksum)
+{
+	return SessionsManager::getWritableDataPath(QLatin1String("favicons/") + QString::fromLatin1(checksum) + QLatin1String(".png"));
+}
+
+QIcon FaviconsManager::loadIcon(const QByteArray &checksum)
+{
+	if (checksum.isEmpty())
+	{
+		return {};
+	}
+
+	QIcon *cachedIcon(m_icons.object(checksum));
+
+	if (cachedIcon)
+	{
+		return *cachedIcon;
+	}
+
+	const QPixmap pixmap(getBlobPath(checksum));
+
+	if (pixmap.isNull())
+	{
+		return {};
+	}
+
+	const QIcon icon(pixmap);
+
+	m_icons.insert(checksum, new QIcon(icon));
+
+	return icon;
+}
+
+QIcon FaviconsManager::getIcon(const QString &host)
+{
+	if (host.isEmpty())
+	{
+		return {};
+	}
+
+	ensureInitialized();
+
+	return loadIcon(m_hosts.value(host));
+}
+
+QIcon FaviconsManager::getIcon(const QUrl &url)
+{
+	ensureInitialized();
+
+	const QIcon icon(loadIcon(m_urls.value(Utils::normalizeUrl(url).toString())));
+
+	return (icon.isNull() ? getIcon(Utils::extractHost(url)) : icon);
+}
+
+}
@@ -0,0 +1,71 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2026 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_FAVICONSMANAGER_H
+#define OTTER_FAVICONSMANAGER_H
+
+#include <QtCore/QCache>
+#include <QtCore/QHash>
+#include <QtCore/QUrl>
+#include <QtGui/QIcon>
+
+namespace Otter
+{
+
+class FaviconsManager final : public QObject
+{
+	Q_OBJECT
+
+public:
+	static void createInstance();
+	static void clearIcons();
+	static void removeIcons(const QVector<QUrl> &urls);
+	static void setIcon(const QUrl &url, const QIcon &icon);
+	static FaviconsManager* getInstance();
+	static QIcon getIcon(const QString &host);
+	static QIcon getIcon(const QUrl &url);
+
+protected:
+	explicit FaviconsManager(QObject *parent);
+
+	void timerEvent(QTimerEvent *event) override;
+	void scheduleSave();
+	void save();
+	static void ensureInitialized();
+	static void addReference(const QByteArray &checksum);
+	static void removeReference(const QByteArray &checksum);
+	static QString getBlobPath(const QByteArray &checksum);
+	static QIcon loadIcon(const QByteArray &checksum);
+
+private:
+	int m_saveTimer;
+
+	static FaviconsManager *m_instance;
+	static QCache<QByteArray, QIcon> m_icons;
+	static QHash<QString, QByteArray> m_urls;
+	static QHash<QString, QByteArray> m_hosts;
+	static QHash<QString, qint64> m_cacheKeys;
+	static QHash<QByteArray, int> m_references;
+	static QVector<QByteArray> m_orphans;
+	static bool m_isInitialized;
+};
+
+}
+
+#endif
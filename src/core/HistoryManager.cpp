@@ -21,6 +21,7 @@
 #include "HistoryManager.h"
 #include "AddonsManager.h"
 #include "Application.h"
+#include "FaviconsManager.h"
 #include "SessionsManager.h"
 #include "SettingsManager.h"
 #include "ThemesManager.h"
@@ -33,6 +34,8 @@ namespace Otter
 HistoryManager* HistoryManager::m_instance(nullptr);
 HistoryModel* HistoryManager::m_browsingHistoryModel(nullptr);
 HistoryModel* HistoryManager::m_typedHistoryModel(nullptr);
+QVector<HistoryManager::InlineCompletionEntry> HistoryManager::m_inlineCompletions;
+bool HistoryManager::m_areInlineCompletionsValid(false);
 bool HistoryManager::m_isEnabled(false);
 bool HistoryManager::m_isStoringFavicons(true);
 
@@ -138,6 +141,11 @@ void HistoryManager::clearHistory(uint period)
 
 	m_browsingHistoryModel->clearRecentEntries(period);
 	m_typedHistoryModel->clearRecentEntries(period);
+
+	if (period == 0)
+	{
+		FaviconsManager::clearIcons();
+	}
 }
 
 void HistoryManager::removeEntry(quint64 identifier)
@@ -167,10 +175,7 @@ void HistoryManager::removeEntries(const QVector<quint64> &identifiers)
 		getBrowsingHistoryModel();
 	}
 
-	for (quint64 identifier: identifiers)
-	{
-		m_browsingHistoryModel->removeEntry(identifier);
-	}
+	m_browsingHistoryModel->removeEntries(identifiers);
 }
 
 void HistoryManager::updateEntry(quint64 identifier, const QUrl &url, const QString &title, const QIcon &icon)
@@ -200,6 +205,11 @@ void HistoryManager::updateEntry(quint64 identifier, const QUrl &url, const QStr
 		entry->setData(title, HistoryModel::TitleRole);
 		entry->setIcon(icon);
 
+		if (m_isStoringFavicons)
+		{
+			FaviconsManager::setIcon(url, icon);
+		}
+
 		m_instance->scheduleSave();
 	}
 }
@@ -264,6 +274,7 @@ HistoryModel* HistoryManager::getBrowsingHistoryModel()
 		m_browsingHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.json")), HistoryModel::BrowsingHistory, m_instance);
 
 		connect(m_browsingHistoryModel, &HistoryModel::modelModified, m_instance, &HistoryManager::scheduleSave);
+		connect(m_browsingHistoryModel, &HistoryModel::urlsRemoved, m_instance, &FaviconsManager::removeIcons);
 	}
 
 	return m_browsingHistoryModel;
@@ -276,6 +287,18 @@ HistoryModel* HistoryManager::getTypedHistoryModel()
 		m_typedHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("typedHistory.json")), HistoryModel::TypedHistory, m_instance);
 
 		connect(m_typedHistoryModel, &HistoryModel::modelModified, m_instance, &HistoryManager::scheduleSave);
+		connect(m_typedHistoryModel, &HistoryModel::cleared, m_instance, [&]()
+		{
+			m_areInlineCompletionsValid = false;
+		});
+		connect(m_typedHistoryModel, &HistoryModel::entryRemoved, m_instance, [&]()
+		{
+			m_areInlineCompletionsValid = false;
+		});
+		connect(m_typedHistoryModel, &HistoryModel::entriesRemoved, m_instance, [&]()
+		{
+			m_areInlineCompletionsValid = false;
+		});
 	}
 
 	return m_typedHistoryModel;
@@ -293,11 +316,9 @@ QDateTime HistoryManager::getLastVisitTime(const QUrl &url)
 
 QIcon HistoryManager::getIcon(const QString &host)
 {
-	Q_UNUSED(host)
-
-///TODO
+	const QIcon icon(FaviconsManager::getIcon(host));
 
-	return ThemesManager::createIcon(QLatin1String("text-html"));
+	return (icon.isNull() ? ThemesManager::createIcon(QLatin1String("text-html")) : icon);
 }
 
 QIcon HistoryManager::getIcon(const QUrl &url)
@@ -322,9 +343,9 @@ QIcon HistoryManager::getIcon(const QUrl &url)
 		}
 	}
 
-///TODO
+	const QIcon icon(FaviconsManager::getIcon(url));
 
-	return ThemesManager::createIcon(QLatin1String("text-html"));
+	return (icon.isNull() ? ThemesManager::createIcon(QLatin1String("text-html")) : icon);
 }
 
 HistoryModel::Entry* HistoryManager::getEntry(quint64 identifier)
@@ -359,6 +380,159 @@ QVector<HistoryModel::HistoryEntryMatch> HistoryManager::findEntries(const QStri
 	return entries;
 }
 
+QString HistoryManager::findInlineCompletion(const QString &prefix)
+{
+	if (prefix.isEmpty())
+	{
+		return {};
+	}
+
+	ensureInlineCompletions();
+
+	const QString key(prefix.toLower());
+	const qint64 currentTime(QDateTime::currentSecsSinceEpoch());
+	QVector<InlineCompletionEntry>::const_iterator iterator(std::lower_bound(m_inlineCompletions.constBegin(), m_inlineCompletions.constEnd(), key, [&](const InlineCompletionEntry &entry, const QString &value)
+	{
+		return (entry.key < value);
+	}));
+	QString completion;
+	qint64 bestScore(0);
+
+	for (; iterator != m_inlineCompletions.constEnd() && iterator->key.startsWith(key); ++iterator)
+	{
+		const qint64 score(getInlineCompletionScore(*iterator, currentTime));
+
+		if (score > bestScore || (score == bestScore && iterator->text.length() < completion.length()))
+		{
+			completion = iterator->text;
+			bestScore = score;
+		}
+	}
+
+	return completion;
+}
+
+void HistoryManager::ensureInlineCompletions()
+{
+	if (m_areInlineCompletionsValid)
+	{
+		return;
+	}
+
+	const HistoryModel *model(getTypedHistoryModel());
+
+	if (!model)
+	{
+		return;
+	}
+
+	const HistoryModel *browsingModel(getBrowsingHistoryModel());
+
+	m_areInlineCompletionsValid = true;
+	m_inlineCompletions.clear();
+
+	for (int i = 0; i < model->rowCount(); ++i)
+	{
+		const QModelIndex index(model->index(i, 0));
+		const QUrl url(index.data(HistoryModel::UrlRole).toUrl());
+
+		addInlineCompletion(url, index.data(HistoryModel::TimeVisitedRole).toDateTime(), qMax(1, browsingModel->getVisitsCount(url)));
+	}
+}
+
+void HistoryManager::addInlineCompletion(const QUrl &url, const QDateTime &time, int visits)
+{
+	if (!url.isValid())
+	{
+		return;
+	}
+
+	const QString host(url.host());
+	const qint64 timeVisited(time.toSecsSinceEpoch());
+	QStringList forms({url.toString()});
+
+	if (!host.isEmpty())
+	{
+		forms.append(url.toString(QUrl::RemoveScheme).mid(2));
+		forms.append(host);
+
+		if (host.startsWith(QLatin1String("www.")) && host.count(QLatin1Char('.')) > 1)
+		{
+			forms.append(forms.at(1).mid(4));
+			forms.append(host.mid(4));
+		}
+	}
+
+	for (const QString &form: std::as_const(forms))
+	{
+		const QString key(form.toLower());
+		QVector<InlineCompletionEntry>::iterator iterator(std::lower_bound(m_inlineCompletions.begin(), m_inlineCompletions.end(), key, [&](const InlineCompletionEntry &entry, const QString &value)
+		{
+			return (entry.key < value);
+		}));
+
+		if (iterator != m_inlineCompletions.end() && iterator->key == key)
+		{
+			iterator->text = form;
+			iterator->timeVisited = qMax(iterator->timeVisited, timeVisited);
+
+			iterator->visits += visits;
+		}
+		else
+		{
+			InlineCompletionEntry entry;
+			entry.key = key;
+			entry.text = form;
+			entry.timeVisited = timeVisited;
+			entry.visits = visits;
+
+			m_inlineCompletions.insert(iterator, entry);
+		}
+	}
+
+	if (m_inlineCompletions.count() > 1500)
+	{
+		const qint64 currentTime(QDateTime::currentSecsSinceEpoch());
+
+		std::sort(m_inlineCompletions.begin(), m_inlineCompletions.end(), [&](const InlineCompletionEntry &first, const InlineCompletionEntry &second)
+		{
+			return (getInlineCompletionScore(first, currentTime) > getInlineCompletionScore(second, currentTime));
+		});
+
+		m_inlineCompletions.resize(1000);
+
+		std::sort(m_inlineCompletions.begin(), m_inlineCompletions.end(), [&](const InlineCompletionEntry &first, const InlineCompletionEntry &second)
+		{
+			return (first.key < second.key);
+		});
+	}
+}
+
+qint64 HistoryManager::getInlineCompletionScore(const InlineCompletionEntry &entry, qint64 currentTime)
+{
+	const qint64 age((currentTime - entry.timeVisited) / 86400);
+	int weight(10);
+
+	if (age < 4)
+	{
+		weight = 100;
+	}
+	else if (age < 14)
+	{
+		weight = 70;
+	}
+	else if (age < 31)
+	{
+		weight = 50;
+	}
+	else if (age < 90)
+	{
+		weight = 30;
+	}
+
+	return (static_cast<qint64>(entry.visits) * weight);
+}
+
 quint64 HistoryManager::addEntry(const QUrl &url, const QString &title, const QIcon &icon, bool isTypedIn)
 {
 	if (!m_isEnabled || !url.isValid() || !SettingsManager::getOption(SettingsManager::History_RememberBrowsingOption, Utils::extractHost(url)).toBool())
@@ -373,6 +547,11 @@ quint64 HistoryManager::addEntry(const QUrl &url, const QString &title, const QI
 
 	const quint64 identifier(m_browsingHistoryModel->addEntry(url, title, icon, QDateTime::currentDateTimeUtc())->getIdentifier());
 
+	if (m_isStoringFavicons)
+	{
+		FaviconsManager::setIcon(url, icon);
+	}
+
 	if (isTypedIn)
 	{
 		if (!m_typedHistoryModel)
@@ -380,19 +559,15 @@ quint64 HistoryManager::addEntry(const QUrl &url, const QString &title, const QI
 			getTypedHistoryModel();
 		}
 
-		m_typedHistoryModel->addEntry(url, title, icon, QDateTime::currentDateTimeUtc());
-	}
+		ensureInlineCompletions();
 
-	const int limit(SettingsManager::getOption(SettingsManager::History_BrowsingLimitAmountGlobalOption).toInt());
+		m_typedHistoryModel->addEntry(url, title, icon, QDateTime::currentDateTimeUtc());
 
-	if (limit > 0 && m_browsingHistoryModel->rowCount() > limit)
-	{
-		for (int i = (m_browsingHistoryModel->rowCount() - 1); i >= limit; --i)
-		{
-			m_browsingHistoryModel->removeEntry(m_browsingHistoryModel->index(i, 0).data(HistoryModel::IdentifierRole).toULongLong());
-		}
+		addInlineCompletion(url, QDateTime::currentDateTimeUtc());
 	}
 
+	m_browsingHistoryModel->clearExcessEntries(SettingsManager::getOption(SettingsManager::History_BrowsingLimitAmountGlobalOption).toInt());
+
 	return identifier;
 }
 
@@ -411,4 +586,9 @@ bool HistoryManager::hasEntry(const QUrl &url)
 	return m_browsingHistoryModel->hasEntry(url);
 }
 
+bool HistoryManager::isEnabled()
+{
+	return m_isEnabled;
+}
+
 }
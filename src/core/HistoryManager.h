@@ -34,6 +34,14 @@ class HistoryManager final : public QObject
 	Q_OBJECT
 
 public:
+	struct InlineCompletionEntry final
+	{
+		QString key;
+		QString text;
+		qint64 timeVisited = 0;
+		int visits = 0;
+	};
+
 	static void createInstance();
 	static void clearHistory(uint period = 0);
 	static void removeEntry(quint64 identifier);
@@ -47,8 +55,10 @@ public:
 	static QIcon getIcon(const QUrl &url);
 	static HistoryModel::Entry* getEntry(quint64 identifier);
 	static QVector<HistoryModel::HistoryEntryMatch> findEntries(const QString &prefix, bool isTypedInOnly = false);
+	static QString findInlineCompletion(const QString &prefix);
 	static quint64 addEntry(const QUrl &url, const QString &title = {}, const QIcon &icon = {}, bool isTypedIn = false);
 	static bool hasEntry(const QUrl &url);
+	static bool isEnabled();
 
 protected:
 	explicit HistoryManager(QObject *parent);
@@ -56,6 +66,9 @@ protected:
 	void timerEvent(QTimerEvent *event) override;
 	void scheduleSave();
 	void save();
+	static void ensureInlineCompletions();
+	static void addInlineCompletion(const QUrl &url, const QDateTime &time, int visits = 1);
+	static qint64 getInlineCompletionScore(const InlineCompletionEntry &entry, qint64 currentTime);
 
 protected slots:
 	void handleOptionChanged(int identifier);
@@ -67,6 +80,8 @@ private:
 	static HistoryManager *m_instance;
 	static HistoryModel *m_browsingHistoryModel;
 	static HistoryModel *m_typedHistoryModel;
+	static QVector<InlineCompletionEntry> m_inlineCompletions;
+	static bool m_areInlineCompletionsValid;
 	static bool m_isEnabled;
 	static bool m_isStoringFavicons;
 
@@ -20,9 +20,9 @@
 
 #include "HistoryModel.h"
 #include "Console.h"
+#include "HistoryManager.h"
 #include "JsonSettings.h"
 #include "SessionsManager.h"
-#include "ThemesManager.h"
 #include "Utils.h"
 
 #include <QtCore/QFile>
@@ -69,9 +69,9 @@ QDateTime HistoryModel::Entry::getTimeVisited() const
 
 QIcon HistoryModel::Entry::getIcon() const
 {
-	const QVariant iconData(data(Qt::DecorationRole));
+	const QIcon icon(data(Qt::DecorationRole).value<QIcon>());
 
-	return (iconData.isNull() ? ThemesManager::createIcon(QLatin1String("text-html")) : iconData.value<QIcon>());
+	return (icon.isNull() ? HistoryManager::getIcon(getUrl()) : icon);
 }
 
 quint64 HistoryModel::Entry::getIdentifier() const
@@ -115,13 +115,25 @@ HistoryModel::HistoryModel(const QString &path, HistoryType type, QObject *paren
 
 void HistoryModel::clearExcessEntries(int limit)
 {
-	if (limit > 0 && rowCount() > limit)
+	if (limit <= 0 || m_times.count() <= limit)
 	{
-		for (int i = (rowCount() - 1); i >= limit; --i)
-		{
-			removeEntry(index(i, 0).data(IdentifierRole).toULongLong());
-		}
+		return;
+	}
+
+	const int amount(m_times.count() - limit);
+	QVector<Entry*> entries;
+	entries.reserve(amount);
+
+	QMultiMap<qint64, Entry*>::const_iterator iterator(m_times.constBegin());
+
+	while (iterator != m_times.constEnd() && entries.count() < amount)
+	{
+		entries.append(iterator.value());
+
+		++iterator;
 	}
+
+	removeEntries(entries);
 }
 
 void HistoryModel::clearRecentEntries(uint period)
@@ -131,20 +143,28 @@ void HistoryModel::clearRecentEntries(uint period)
 		clear();
 
 		m_urls.clear();
+		m_snapshotPositions.clear();
+		m_snapshotEntries.clear();
+		m_snapshot.reset();
 		m_identifiers.clear();
+		m_times.clear();
 
 		emit cleared();
 
 		return;
 	}
 
-	for (int i = (rowCount() - 1); i >= 0; --i)
+	QVector<Entry*> entries;
+	QMultiMap<qint64, Entry*>::const_iterator iterator(m_times.upperBound(QDateTime::currentDateTimeUtc().addSecs(-static_cast<qint64>(period) * 3600).toMSecsSinceEpoch()));
+
+	while (iterator != m_times.constEnd())
 	{
-		if (index(i, 0).data(TimeVisitedRole).toDateTime().secsTo(QDateTime::currentDateTimeUtc()) < (static_cast<qint64>(period) * 3600))
-		{
-			removeEntry(index(i, 0).data(IdentifierRole).toULongLong());
-		}
+		entries.append(iterator.value());
+
+		++iterator;
 	}
+
+	removeEntries(entries);
 }
 
 void HistoryModel::clearOldestEntries(int period)
@@ -154,15 +174,18 @@ void HistoryModel::clearOldestEntries(int period)
 		return;
 	}
 
-	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	const qint64 threshold(QDateTime(QDateTime::currentDateTimeUtc().date().addDays(-period), QTime(0, 0), QTimeZone::utc()).toMSecsSinceEpoch());
+	QVector<Entry*> entries;
+	QMultiMap<qint64, Entry*>::const_iterator iterator(m_times.constBegin());
 
-	for (int i = (rowCount() - 1); i >= 0; --i)
+	while (iterator != m_times.constEnd() && iterator.key() < threshold)
 	{
-		if (index(i, 0).data(TimeVisitedRole).toDateTime().daysTo(currentDateTime) > period)
-		{
-			removeEntry(index(i, 0).data(IdentifierRole).toULongLong());
-		}
+		entries.append(iterator.value());
+
+		++iterator;
 	}
+
+	removeEntries(entries);
 }
 
 void HistoryModel::removeEntry(quint64 identifier)
@@ -175,29 +198,188 @@ void HistoryModel::removeEntry(quint64 identifier)
 	}
 
 	const QUrl url(Utils::normalizeUrl(entry->getUrl()));
+	const bool isUrlRemoved(removeUrl(entry, url));
 
-	if (m_urls.contains(url))
+	if (identifier > 0 && m_identifiers.contains(identifier))
 	{
-		m_urls[url].removeAll(entry);
+		m_identifiers.remove(identifier);
+	}
+
+	m_times.remove(entry->getTimeVisited().toMSecsSinceEpoch(), entry);
 
-		if (m_urls[url].isEmpty())
+	emit entryRemoved(entry);
+
+	removeRow(entry->row());
+
+	if (isUrlRemoved)
+	{
+		emit urlsRemoved({url});
+	}
+
+	emit modelModified();
+}
+
+void HistoryModel::removeEntries(const QVector<quint64> &identifiers)
+{
+	QVector<Entry*> entries;
+	entries.reserve(identifiers.count());
+
+	for (const quint64 identifier: identifiers)
+	{
+		Entry *entry(getEntry(identifier));
+
+		if (entry)
 		{
-			m_urls.remove(url);
+			entries.append(entry);
 		}
 	}
 
-	if (identifier > 0 && m_identifiers.contains(identifier))
+	removeEntries(entries);
+}
+
+void HistoryModel::removeEntries(const QVector<Entry*> &entries)
+{
+	if (entries.isEmpty())
+	{
+		return;
+	}
+
+	if (entries.count() == 1)
 	{
+		removeEntry(entries.at(0)->getIdentifier());
+
+		return;
+	}
+
+	QVector<QUrl> urls;
+	QVector<int> rows;
+	rows.reserve(entries.count());
+
+	for (Entry *entry: entries)
+	{
+		const quint64 identifier(entry->getIdentifier());
+
+		if (!m_identifiers.contains(identifier))
+		{
+			continue;
+		}
+
+		const QUrl url(Utils::normalizeUrl(entry->getUrl()));
+
+		if (removeUrl(entry, url))
+		{
+			urls.append(url);
+		}
+
 		m_identifiers.remove(identifier);
+		m_times.remove(entry->getTimeVisited().toMSecsSinceEpoch(), entry);
+
+		rows.append(entry->row());
 	}
 
-	emit entryRemoved(entry);
+	std::sort(rows.begin(), rows.end(), std::greater<int>());
 
-	removeRow(entry->row());
+	beginResetModel();
+	blockSignals(true);
+
+	int i(0);
+
+	while (i < rows.count())
+	{
+		int row(rows.at(i));
+		int amount(1);
+
+		while ((i + amount) < rows.count() && rows.at(i + amount) == (row - 1))
+		{
+			--row;
+			++amount;
+		}
+
+		removeRows(row, amount);
+
+		i += amount;
+	}
+
+	blockSignals(false);
+	endResetModel();
+
+	emit entriesRemoved();
+
+	if (!urls.isEmpty())
+	{
+		emit urlsRemoved(urls);
+	}
 
 	emit modelModified();
 }
 
+void HistoryModel::updateSnapshot(const QUrl &url)
+{
+	// Drop shared copy first, so entries are updated in place unless search still uses them
+	m_snapshot.reset();
+
+	const Entry *entry(m_urls.value(url).value(0));
+	const int position(m_snapshotPositions.value(url, -1));
+
+	if (!entry)
+	{
+		if (position < 0)
+		{
+			return;
+		}
+
+		const int lastPosition(m_snapshotEntries.count() - 1);
+
+		if (position != lastPosition)
+		{
+			m_snapshotEntries[position] = m_snapshotEntries.at(lastPosition);
+			m_snapshotPositions[m_snapshotEntries.at(position).url] = position;
+		}
+
+		m_snapshotEntries.removeLast();
+		m_snapshotPositions.remove(url);
+
+		return;
+	}
+
+	EntrySnapshot snapshot;
+	snapshot.url = url;
+	snapshot.timeVisited = entry->getTimeVisited().toMSecsSinceEpoch();
+	snapshot.identifier = entry->getIdentifier();
+
+	if (position < 0)
+	{
+		m_snapshotPositions[url] = m_snapshotEntries.count();
+
+		m_snapshotEntries.append(snapshot);
+	}
+	else
+	{
+		m_snapshotEntries[position] = snapshot;
+	}
+}
+
+bool HistoryModel::removeUrl(Entry *entry, const QUrl &url)
+{
+	if (url.isEmpty() || !m_urls.contains(url))
+	{
+		return false;
+	}
+
+	m_urls[url].removeAll(entry);
+
+	const bool isUrlRemoved(m_urls[url].isEmpty());
+
+	if (isUrlRemoved)
+	{
+		m_urls.remove(url);
+	}
+
+	updateSnapshot(url);
+
+	return isUrlRemoved;
+}
+
 HistoryModel::Entry* HistoryModel::addEntry(const QUrl &url, const QString &title, const QIcon &icon, const QDateTime &date, quint64 identifier)
 {
 	blockSignals(true);
@@ -215,9 +397,9 @@ HistoryModel::Entry* HistoryModel::addEntry(const QUrl &url, const QString &titl
 	Entry *entry(new Entry());
 	entry->setIcon(icon);
 
-	const QModelIndex index(entry->index());
-
 	insertRow(0, entry);
+
+	const QModelIndex index(entry->index());
 	setData(index, url, UrlRole);
 	setData(index, title, TitleRole);
 	setData(index, date, TimeVisitedRole);
@@ -274,54 +456,73 @@ QDateTime HistoryModel::getLastVisitTime(const QUrl &url) const
 	return lastVisitTime;
 }
 
+int HistoryModel::getVisitsCount(const QUrl &url) const
+{
+	return m_urls.value(Utils::normalizeUrl(url)).count();
+}
+
 QVector<HistoryModel::HistoryEntryMatch> HistoryModel::findEntries(const QString &prefix, bool markAsTypedIn) const
 {
-	QVector<Entry*> matchedEntries;
-	QVector<HistoryEntryMatch> allMatches;
-	QVector<HistoryEntryMatch> currentMatches;
-	QMultiMap<QDateTime, HistoryEntryMatch> matchesMap;
-	QHash<QUrl, QVector<Entry*> >::const_iterator urlsIterator;
+	QVector<HistoryEntryMatch> matches(findEntries(getSnapshot(), prefix, markAsTypedIn));
 
-	for (urlsIterator = m_urls.constBegin(); urlsIterator != m_urls.constEnd(); ++urlsIterator)
+	for (int i = 0; i < matches.count(); ++i)
 	{
-		if (urlsIterator.value().isEmpty() || matchedEntries.contains(urlsIterator.value().value(0)))
-		{
-			continue;
-		}
+		matches[i].entry = getEntry(matches.at(i).identifier);
+	}
 
-		const QString result(Utils::matchUrl(urlsIterator.key(), prefix));
+	return matches;
+}
+
+QVector<HistoryModel::HistoryEntryMatch> HistoryModel::findEntries(const QSharedPointer<const QVector<EntrySnapshot> > &snapshot, const QString &prefix, bool markAsTypedIn)
+{
+	if (!snapshot)
+	{
+		return {};
+	}
+
+	QVector<QPair<qint64, HistoryEntryMatch> > currentMatches;
+
+	for (const EntrySnapshot &entry: std::as_const(*snapshot))
+	{
+		const QString result(Utils::matchUrl(entry.url, prefix));
 
 		if (!result.isEmpty())
 		{
 			HistoryEntryMatch match;
-			match.entry = urlsIterator.value().value(0);
 			match.match = result;
+			match.identifier = entry.identifier;
+			match.isTypedIn = markAsTypedIn;
 
-			if (markAsTypedIn)
-			{
-				match.isTypedIn = true;
-			}
-
-			matchesMap.insert(match.entry->data(TimeVisitedRole).toDateTime(), match);
-
-			matchedEntries.append(match.entry);
+			currentMatches.append({entry.timeVisited, match});
 		}
 	}
 
-	currentMatches = matchesMap.values().toVector();
-
-	matchesMap.clear();
+	std::stable_sort(currentMatches.begin(), currentMatches.end(), [&](const QPair<qint64, HistoryEntryMatch> &first, const QPair<qint64, HistoryEntryMatch> &second)
+	{
+		return (first.first > second.first);
+	});
 
+	QVector<HistoryEntryMatch> allMatches;
 	allMatches.reserve(currentMatches.count());
 
-	for (int i = (currentMatches.count() - 1); i >= 0; --i)
+	for (int i = 0; i < currentMatches.count(); ++i)
 	{
-		allMatches.append(currentMatches.at(i));
+		allMatches.append(currentMatches.at(i).second);
 	}
 
 	return allMatches;
 }
 
+QSharedPointer<const QVector<HistoryModel::EntrySnapshot> > HistoryModel::getSnapshot() const
+{
+	if (!m_snapshot)
+	{
+		m_snapshot.reset(new QVector<EntrySnapshot>(m_snapshotEntries));
+	}
+
+	return m_snapshot;
+}
+
 HistoryModel::HistoryType HistoryModel::getType() const
 {
 	return m_type;
@@ -365,16 +566,7 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
 	{
 		const QUrl oldUrl(Utils::normalizeUrl(index.data(UrlRole).toUrl()));
 		const QUrl newUrl(Utils::normalizeUrl(value.toUrl()));
-
-		if (!oldUrl.isEmpty() && m_urls.contains(oldUrl))
-		{
-			m_urls[oldUrl].removeAll(entry);
-
-			if (m_urls[oldUrl].isEmpty())
-			{
-				m_urls.remove(oldUrl);
-			}
-		}
+		const bool isUrlRemoved(removeUrl(entry, oldUrl));
 
 		if (!newUrl.isEmpty())
 		{
@@ -384,17 +576,42 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
 			}
 
 			m_urls[newUrl].append(entry);
+
+			updateSnapshot(newUrl);
+		}
+
+		if (isUrlRemoved && oldUrl != newUrl)
+		{
+			emit urlsRemoved({oldUrl});
+		}
+	}
+
+	if (role == TimeVisitedRole)
+	{
+		const QVariant oldValue(index.data(TimeVisitedRole));
+
+		if (!oldValue.isNull())
+		{
+			m_times.remove(oldValue.toDateTime().toMSecsSinceEpoch(), entry);
 		}
+
+		m_times.insert(value.toDateTime().toMSecsSinceEpoch(), entry);
 	}
 
 	entry->setItemData(value, role);
 
 	switch (role)
 	{
-		case TitleRole:
-		case UrlRole:
 		case IdentifierRole:
 		case TimeVisitedRole:
+			updateSnapshot(Utils::normalizeUrl(entry->getUrl()));
+
+			emit entryModified(entry);
+			emit modelModified();
+
+			break;
+		case UrlRole:
+		case TitleRole:
 			emit entryModified(entry);
 			emit modelModified();
 
@@ -22,6 +22,7 @@
 #define OTTER_HISTORYMODEL_H
 
 #include <QtCore/QDateTime>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QUrl>
 #include <QtGui/QStandardItemModel>
 
@@ -69,27 +70,48 @@ public:
 	{
 		Entry *entry = nullptr;
 		QString match;
+		quint64 identifier = 0;
 		bool isTypedIn = false;
 	};
 
+	struct EntrySnapshot final
+	{
+		QUrl url;
+		qint64 timeVisited = 0;
+		quint64 identifier = 0;
+	};
+
 	explicit HistoryModel(const QString &path, HistoryType type, QObject *parent = nullptr);
 
 	void clearExcessEntries(int limit);
 	void clearRecentEntries(uint period);
 	void clearOldestEntries(int period);
 	void removeEntry(quint64 identifier);
+	void removeEntries(const QVector<quint64> &identifiers);
 	Entry* addEntry(const QUrl &url, const QString &title, const QIcon &icon, const QDateTime &date = QDateTime::currentDateTimeUtc(), quint64 identifier = 0);
 	Entry* getEntry(quint64 identifier) const;
 	QDateTime getLastVisitTime(const QUrl &url) const;
 	QVector<HistoryEntryMatch> findEntries(const QString &prefix, bool markAsTypedIn = false) const;
+	QSharedPointer<const QVector<EntrySnapshot> > getSnapshot() const;
 	HistoryType getType() const;
+	static QVector<HistoryEntryMatch> findEntries(const QSharedPointer<const QVector<EntrySnapshot> > &snapshot, const QString &prefix, bool markAsTypedIn = false);
+	int getVisitsCount(const QUrl &url) const;
 	bool hasEntry(const QUrl &url) const;
 	bool save(const QString &path) const;
 	bool setData(const QModelIndex &index, const QVariant &value, int role) override;
 
+protected:
+	void removeEntries(const QVector<Entry*> &entries);
+	void updateSnapshot(const QUrl &url);
+	bool removeUrl(Entry *entry, const QUrl &url);
+
 private:
 	QHash<QUrl, QVector<Entry*> > m_urls;
 	QMap<quint64, Entry*> m_identifiers;
+	QMultiMap<qint64, Entry*> m_times;
+	QHash<QUrl, int> m_snapshotPositions;
+	QVector<EntrySnapshot> m_snapshotEntries;
+	mutable QSharedPointer<const QVector<EntrySnapshot> > m_snapshot;
 	HistoryType m_type;
 
 signals:
@@ -97,6 +119,8 @@ signals:
 	void entryAdded(Entry *entry);
 	void entryModified(Entry *entry);
 	void entryRemoved(Entry *entry);
+	void entriesRemoved();
+	void urlsRemoved(const QVector<QUrl> &urls);
 	void modelModified();
 };
 
@@ -41,20 +41,17 @@ PacUtils::PacUtils(QObject *parent) : QObject(parent)
 
 void PacUtils::alert(const QString &message) const
 {
-	Console::addMessage(message, Console::NetworkCategory, Console::DebugLevel);
+	QMetaObject::invokeMethod(QCoreApplication::instance(), [=]()
+	{
+		Console::addMessage(message, Console::NetworkCategory, Console::DebugLevel);
+	}, Qt::QueuedConnection);
 }
 
 QString PacUtils::dnsResolve(const QString &host) const
 {
-	const QHostInfo hostInformation(QHostInfo::fromName(host));
-	const QList<QHostAddress> addresses(hostInformation.addresses());
+	const QList<QHostAddress> addresses(resolveHost(host));
 
-	if (hostInformation.error() == QHostInfo::NoError && !addresses.isEmpty())
-	{
-		return addresses.first().toString();
-	}
-
-	return {};
+	return (addresses.isEmpty() ? QString() : addresses.first().toString());
 }
 
 QString PacUtils::myIpAddress() const
@@ -98,7 +95,7 @@ bool PacUtils::isPlainHostName(const QString &host) const
 
 bool PacUtils::isResolvable(const QString &host) const
 {
-	return (QHostInfo::fromName(host).error() == QHostInfo::NoError);
+	return !resolveHost(host).isEmpty();
 }
 
 bool PacUtils::localHostOrDomainIs(const QString &host, QString domain) const
@@ -292,6 +289,34 @@ bool PacUtils::timeRange(const QVariant &arg1, const QVariant &arg2, const QVari
 	return false;
 }
 
+QList<QHostAddress> PacUtils::resolveHost(const QString &host) const
+{
+	const qint64 currentTime(QDateTime::currentMSecsSinceEpoch());
+
+	if (m_hosts.contains(host) && m_hosts[host].expirationTime > currentTime)
+	{
+		return m_hosts[host].addresses;
+	}
+
+	if (m_hosts.count() > 1000)
+	{
+		m_hosts.clear();
+	}
+
+	const QHostInfo hostInformation(QHostInfo::fromName(host));
+	HostInformation information;
+	information.expirationTime = (currentTime + 60000);
+
+	if (hostInformation.error() == QHostInfo::NoError)
+	{
+		information.addresses = hostInformation.addresses();
+	}
+
+	m_hosts[host] = information;
+
+	return information.addresses;
+}
+
 bool PacUtils::isDateInRange(const QDate &from, const QDate &to, const QDate &value) const
 {
 	return (value >= from && value <= to);
@@ -307,35 +332,98 @@ bool PacUtils::isNumberInRange(int from, int to, int value) const
 	return (value >= from && value <= to);
 }
 
-NetworkAutomaticProxy::NetworkAutomaticProxy(const QString &path, QObject *parent) : QObject(parent),
-	m_path(path),
-	m_isValid(false)
+NetworkAutomaticProxyWorker::NetworkAutomaticProxyWorker(QObject *parent) : QObject(parent),
+	m_engine(nullptr)
 {
-	m_engine.globalObject().setProperty(QLatin1String("PacUtils"), m_engine.newQObject(new PacUtils(this)));
+}
+
+QString NetworkAutomaticProxyWorker::findProxy(const QString &url, const QString &host)
+{
+	if (!m_engine || !m_findProxyFunction.isCallable())
+	{
+		return QLatin1String("ERROR");
+	}
+
+	const QJSValue result(m_findProxyFunction.call(QJSValueList({m_engine->toScriptValue(url), m_engine->toScriptValue(host)})));
+
+	if (result.isError())
+	{
+		return QLatin1String("ERROR");
+	}
+
+	return result.toString().remove(QLatin1Char(' '));
+}
+
+bool NetworkAutomaticProxyWorker::setup(const QString &script)
+{
+	m_findProxyFunction = QJSValue();
+
+	delete m_engine;
+
+	m_engine = new QJSEngine(this);
+	m_engine->globalObject().setProperty(QLatin1String("PacUtils"), m_engine->newQObject(new PacUtils(m_engine)));
 
 	const QStringList functions({QLatin1String("alert"), QLatin1String("dnsResolve"), QLatin1String("myIpAddress"), QLatin1String("dnsDomainLevels"), QLatin1String("isInNet"), QLatin1String("isPlainHostName"), QLatin1String("isResolvable"), QLatin1String("localHostOrDomainIs"), QLatin1String("dnsDomainIs"), QLatin1String("shExpMatch"), QLatin1String("weekdayRange"), QLatin1String("dateRange"), QLatin1String("timeRange")});
 
 	for (const QString &function: functions)
 	{
-		m_engine.evaluate(QStringLiteral("function %1() { return PacUtils.%1.apply(null, arguments); }").arg(function)).isError();
+		m_engine->evaluate(QStringLiteral("function %1() { return PacUtils.%1.apply(null, arguments); }").arg(function)).isError();
 	}
 
+	if (m_engine->evaluate(script).isError())
+	{
+		return false;
+	}
+
+	m_findProxyFunction = m_engine->globalObject().property(QLatin1String("FindProxyForURL"));
+
+	return m_findProxyFunction.isCallable();
+}
+
+NetworkAutomaticProxy::NetworkAutomaticProxy(const QString &path, QObject *parent) : QObject(parent),
+	m_worker(new NetworkAutomaticProxyWorker()),
+	m_workerThread(new QThread(this)),
+	m_path(path),
+	m_generation(0),
+	m_isValid(false)
+{
 	m_proxies.insert(QLatin1String("ERROR"), QVector<QNetworkProxy>({QNetworkProxy(QNetworkProxy::DefaultProxy)}));
 	m_proxies.insert(QLatin1String("DIRECT"), QVector<QNetworkProxy>({QNetworkProxy(QNetworkProxy::NoProxy)}));
 
+	m_worker->moveToThread(m_workerThread);
+
+	connect(m_workerThread, &QThread::finished, m_worker, &NetworkAutomaticProxyWorker::deleteLater);
+
+	m_workerThread->start();
+
 	setPath(path);
 }
 
+NetworkAutomaticProxy::~NetworkAutomaticProxy()
+{
+	m_workerThread->quit();
+	m_workerThread->wait();
+}
+
 void NetworkAutomaticProxy::setPath(const QString &path)
 {
+	m_mutex.lock();
+
+	m_path = path;
+	m_isValid = false;
+
+	m_results.clear();
+
+	++m_generation;
+
+	m_mutex.unlock();
+
 	if (QFile::exists(path))
 	{
 		QFile file(path);
 
 		if (file.open(QIODevice::ReadOnly | QIODevice::Text) && setup(QString::fromLatin1(file.readAll())))
 		{
-			m_isValid = true;
-
 			file.close();
 		}
 		else
@@ -356,11 +444,7 @@ void NetworkAutomaticProxy::setPath(const QString &path)
 		{
 			QIODevice *device(job->getData());
 
-			if (isSuccess && device && setup(QString::fromLatin1(device->readAll())))
-			{
-				m_isValid = true;
-			}
-			else
+			if (!isSuccess || !device || !setup(QString::fromLatin1(device->readAll())))
 			{
 				Console::addMessage(tr("Failed to load proxy auto-config (PAC): %1").arg(device ? device->errorString() : tr("Download failure")), Console::NetworkCategory, Console::ErrorLevel, url.url());
 			}
@@ -381,15 +465,80 @@ QString NetworkAutomaticProxy::getPath() const
 
 QVector<QNetworkProxy> NetworkAutomaticProxy::getProxy(const QString &url, const QString &host)
 {
-	const QJSValue result(m_findProxyFunction.call(QJSValueList({m_engine.toScriptValue(url), m_engine.toScriptValue(host)})));
+	// Scripts can decide based on any part of URL, including port and path
+	m_mutex.lock();
 
-	if (result.isError())
+	const quint64 generation(m_generation);
+
+	if (m_results.contains(url))
 	{
-		return m_proxies[QLatin1String("ERROR")];
+		ResultEntry &entry(m_results[url]);
+		const QVector<QNetworkProxy> proxies(entry.proxies);
+
+		if (!entry.isUpdating && entry.expirationTime < QDateTime::currentMSecsSinceEpoch())
+		{
+			entry.isUpdating = true;
+
+			QMetaObject::invokeMethod(m_worker, [=]()
+			{
+				const QString configuration(m_worker->findProxy(url, host));
+
+				QMetaObject::invokeMethod(this, [=]()
+				{
+					storeResult(url, configuration, generation);
+				}, Qt::QueuedConnection);
+			}, Qt::QueuedConnection);
+		}
+
+		m_mutex.unlock();
+
+		return proxies;
 	}
 
-	const QString configuration(result.toString().remove(QLatin1Char(' ')));
+	m_mutex.unlock();
 
+	QString configuration;
+
+	if (QThread::currentThread() == m_workerThread)
+	{
+		configuration = m_worker->findProxy(url, host);
+	}
+	else
+	{
+		QMetaObject::invokeMethod(m_worker, [=]()
+		{
+			return m_worker->findProxy(url, host);
+		}, Qt::BlockingQueuedConnection, &configuration);
+	}
+
+	return storeResult(url, configuration, generation);
+}
+
+QVector<QNetworkProxy> NetworkAutomaticProxy::storeResult(const QString &url, const QString &configuration, quint64 generation)
+{
+	QMutexLocker locker(&m_mutex);
+
+	ResultEntry entry;
+	entry.proxies = parseConfiguration(configuration);
+	entry.expirationTime = (QDateTime::currentMSecsSinceEpoch() + ResultTimeToLive);
+
+	if (generation != m_generation)
+	{
+		return entry.proxies;
+	}
+
+	if (m_results.count() > 1000)
+	{
+		m_results.clear();
+	}
+
+	m_results[url] = entry;
+
+	return entry.proxies;
+}
+
+QVector<QNetworkProxy> NetworkAutomaticProxy::parseConfiguration(const QString &configuration)
+{
 	if (!m_proxies.value(configuration).isEmpty())
 	{
 		return m_proxies[configuration];
@@ -444,19 +593,31 @@ QVector<QNetworkProxy> NetworkAutomaticProxy::getProxy(const QString &url, const
 
 bool NetworkAutomaticProxy::isValid() const
 {
+	QMutexLocker locker(&m_mutex);
+
 	return m_isValid;
 }
 
 bool NetworkAutomaticProxy::setup(const QString &script)
 {
-	if (m_engine.evaluate(script).isError())
+	bool isValid(false);
+
+	QMetaObject::invokeMethod(m_worker, [=]()
 	{
-		return false;
-	}
+		return m_worker->setup(script);
+	}, Qt::BlockingQueuedConnection, &isValid);
 
-	m_findProxyFunction = m_engine.globalObject().property(QLatin1String("FindProxyForURL"));
+	m_mutex.lock();
 
-	return m_findProxyFunction.isCallable();
+	m_isValid = isValid;
+
+	m_results.clear();
+
+	++m_generation;
+
+	m_mutex.unlock();
+
+	return isValid;
 }
 
 }
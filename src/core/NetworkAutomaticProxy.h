@@ -21,6 +21,9 @@
 #ifndef OTTER_NETWORKAUTOMATICPROXY_H
 #define OTTER_NETWORKAUTOMATICPROXY_H
 
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtNetwork/QHostAddress>
 #include <QtNetwork/QNetworkProxy>
 #include <QtQml/QJSEngine>
 
@@ -50,19 +53,47 @@ public slots:
 	bool timeRange(const QVariant &arg1, const QVariant &arg2, const QVariant &arg3, const QVariant &arg4, const QVariant &arg5, const QVariant &arg6, const QString &gmt = QLatin1String("gmt")) const;
 
 protected:
+	struct HostInformation final
+	{
+		QList<QHostAddress> addresses;
+		qint64 expirationTime = 0;
+	};
+
+	QList<QHostAddress> resolveHost(const QString &host) const;
 	bool isDateInRange(const QDate &from, const QDate &to, const QDate &value) const;
 	bool isTimeInRange(const QTime &from, const QTime &to, const QTime &value) const;
 	bool isNumberInRange(int from, int to, int value) const;
 
 private:
+	mutable QHash<QString, HostInformation> m_hosts;
+
 	static QStringList m_months;
 	static QStringList m_days;
 };
 
+class NetworkAutomaticProxyWorker final : public QObject
+{
+public:
+	explicit NetworkAutomaticProxyWorker(QObject *parent = nullptr);
+
+	QString findProxy(const QString &url, const QString &host);
+	bool setup(const QString &script);
+
+private:
+	QJSEngine *m_engine;
+	QJSValue m_findProxyFunction;
+};
+
 class NetworkAutomaticProxy final : public QObject
 {
 public:
+	enum
+	{
+		ResultTimeToLive = 300000
+	};
+
 	explicit NetworkAutomaticProxy(const QString &path, QObject *parent = nullptr);
+	~NetworkAutomaticProxy();
 
 	void setPath(const QString &path);
 	QString getPath() const;
@@ -70,13 +101,25 @@ public:
 	bool isValid() const;
 
 protected:
+	struct ResultEntry final
+	{
+		QVector<QNetworkProxy> proxies;
+		qint64 expirationTime = 0;
+		bool isUpdating = false;
+	};
+
+	QVector<QNetworkProxy> storeResult(const QString &url, const QString &configuration, quint64 generation);
+	QVector<QNetworkProxy> parseConfiguration(const QString &configuration);
 	bool setup(const QString &script);
 
 private:
-	QJSEngine m_engine;
-	QJSValue m_findProxyFunction;
+	NetworkAutomaticProxyWorker *m_worker;
+	QThread *m_workerThread;
 	QString m_path;
 	QHash<QString, QVector<QNetworkProxy> > m_proxies;
+	QHash<QString, ResultEntry> m_results;
+	mutable QMutex m_mutex;
+	quint64 m_generation;
 	bool m_isValid;
 };
 
@@ -18,174 +18,1259 @@
 **************************************************************************/
 
 #include "NetworkCache.h"
+#include "Application.h"
+#include "BookmarksManager.h"
 #include "SettingsManager.h"
+#include "../ui/MainWindow.h"
+#include "../ui/Window.h"
 
-#include <QtCore/QDateTime>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTimer>
+#include <QtCore/QTimerEvent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace Otter
 {
 
-NetworkCache::NetworkCache(const QString &path, QObject *parent) : QNetworkDiskCache(parent)
+NetworkCacheWriter::NetworkCacheWriter(const QString &path, qint64 maximumSize) : QNetworkDiskCache(),
+	m_clearedGeneration(0)
+{
+	setCacheDirectory(path);
+	setMaximumCacheSize(maximumSize);
+}
+
+void NetworkCacheWriter::write(const QNetworkCacheMetaData &metaData, const QByteArray &data, quint64 generation)
+{
+	if (isCancelled(metaData.url(), generation))
+	{
+		emit entryWritten(metaData.url(), data.size(), 0, generation);
+
+		return;
+	}
+
+	QNetworkCacheMetaData storedMetaData(metaData);
+	QByteArray storedData(data);
+	qint64 compressionTime(0);
+
+	if (data.size() >= 256 && isCompressible(metaData))
+	{
+		QElapsedTimer timer;
+		timer.start();
+
+		const QByteArray compressedData(qCompress(data));
+
+		compressionTime = timer.nsecsElapsed();
+
+		if (compressedData.size() < ((data.size() * 9) / 10))
+		{
+			QNetworkCacheMetaData::AttributesMap attributes(metaData.attributes());
+			attributes[static_cast<QNetworkRequest::Attribute>(NetworkCache::CompressedAttribute)] = true;
+
+			storedMetaData.setAttributes(attributes);
+			storedData = compressedData;
+		}
+	}
+
+	QIODevice *device(prepare(storedMetaData));
+
+	if (device)
+	{
+		if (device->write(storedData) == storedData.size() && !isCancelled(metaData.url(), generation))
+		{
+			insert(device);
+
+			// Entry could have been cancelled while it was being committed
+			if (isCancelled(metaData.url(), generation))
+			{
+				remove(metaData.url());
+			}
+		}
+		else
+		{
+			remove(metaData.url());
+		}
+	}
+
+	emit entryWritten(metaData.url(), data.size(), compressionTime, generation);
+}
+
+void NetworkCacheWriter::cancelWrites(const QHash<QUrl, quint64> &generations)
+{
+	QMutexLocker locker(&m_mutex);
+	QHash<QUrl, quint64>::const_iterator iterator;
+
+	for (iterator = generations.constBegin(); iterator != generations.constEnd(); ++iterator)
+	{
+		if (iterator.value() > m_cancelledWrites.value(iterator.key()))
+		{
+			m_cancelledWrites[iterator.key()] = iterator.value();
+		}
+	}
+}
+
+void NetworkCacheWriter::cancelAllWrites(quint64 generation)
+{
+	QMutexLocker locker(&m_mutex);
+
+	m_cancelledWrites.clear();
+
+	m_clearedGeneration = generation;
+}
+
+void NetworkCacheWriter::removeEntries(const QVector<QUrl> &urls)
+{
+	for (const QUrl &url: urls)
+	{
+		remove(url);
+	}
+}
+
+void NetworkCacheWriter::removeOrphans(const QSet<QString> &paths, const QDateTime &dateTime)
+{
+	QDirIterator iterator(cacheDirectory(), {QLatin1String("*.d")}, QDir::Files, QDirIterator::Subdirectories);
+
+	while (iterator.hasNext())
+	{
+		iterator.next();
+
+		const QString path(iterator.filePath().mid(cacheDirectory().length()));
+
+		if (!path.startsWith(QLatin1String("prepared/")) && !paths.contains(path) && iterator.fileInfo().lastModified().toUTC() < dateTime)
+		{
+			QFile::remove(iterator.filePath());
+		}
+	}
+}
+
+bool NetworkCacheWriter::isCompressible(const QNetworkCacheMetaData &metaData)
+{
+	const QList<QPair<QByteArray, QByteArray> > headers(metaData.rawHeaders());
+	QByteArray type;
+	qint64 length(-1);
+
+	for (const QPair<QByteArray, QByteArray> &header: headers)
+	{
+		if (header.first.compare(QByteArrayLiteral("Content-Encoding"), Qt::CaseInsensitive) == 0)
+		{
+			const QByteArray encoding(header.second.trimmed().toLower());
+
+			if (!encoding.isEmpty() && encoding != QByteArrayLiteral("identity"))
+			{
+				return false;
+			}
+		}
+		else if (header.first.compare(QByteArrayLiteral("Content-Length"), Qt::CaseInsensitive) == 0)
+		{
+			length = header.second.toLongLong();
+		}
+		else if (header.first.compare(QByteArrayLiteral("Content-Type"), Qt::CaseInsensitive) == 0)
+		{
+			type = header.second.split(';').first().trimmed().toLower();
+		}
+	}
+
+	const bool isText(type.startsWith(QByteArrayLiteral("text/")) || (type.startsWith(QByteArrayLiteral("application/")) && (type.endsWith(QByteArrayLiteral("javascript")) || type.endsWith(QByteArrayLiteral("ecmascript")))));
+
+	// QNetworkDiskCache compresses these on its own when their size is known
+	if (isText && length >= 0 && length <= (3 * 1024 * 1024))
+	{
+		return false;
+	}
+
+	return (isText || type.endsWith(QByteArrayLiteral("json")) || type.endsWith(QByteArrayLiteral("xml")));
+}
+
+bool NetworkCacheWriter::isCancelled(const QUrl &url, quint64 generation)
+{
+	QMutexLocker locker(&m_mutex);
+	const quint64 cancelledGeneration(m_cancelledWrites.value(url));
+
+	if (generation > cancelledGeneration && generation > m_clearedGeneration)
+	{
+		return false;
+	}
+
+	if (generation == cancelledGeneration)
+	{
+		m_cancelledWrites.remove(url);
+	}
+
+	return true;
+}
+
+qint64 NetworkCacheWriter::expire()
+{
+	// Eviction is driven by the index kept by NetworkCache
+	return 0;
+}
+
+NetworkCacheWriteBuffer::NetworkCacheWriteBuffer(NetworkCache *cache, qint64 limit) : QBuffer(),
+	m_cache(cache),
+	m_limit(limit),
+	m_isOverflowed(false)
+{
+}
+
+qint64 NetworkCacheWriteBuffer::writeData(const char *data, qint64 length)
+{
+	if (m_isOverflowed)
+	{
+		return length;
+	}
+
+	if ((size() + length) > m_limit || !m_cache->reserveBufferSize(length))
+	{
+		m_cache->m_bufferedSize -= size();
+
+		discard();
+
+		return length;
+	}
+
+	return QBuffer::writeData(data, length);
+}
+
+void NetworkCacheWriteBuffer::discard()
+{
+	m_isOverflowed = true;
+
+	buffer().clear();
+}
+
+bool NetworkCacheWriteBuffer::isOverflowed() const
+{
+	return m_isOverflowed;
+}
+
+NetworkCache::NetworkCache(const QString &path, QObject *parent) : QNetworkDiskCache(parent),
+	m_writer(nullptr),
+	m_writerThread(nullptr),
+	m_memoryCacheHits(0),
+	m_memoryCacheMisses(0),
+	m_pendingWritesSize(0),
+	m_bufferedSize(0),
+	m_cacheSize(-1),
+	m_totalSize(0),
+	m_writeGeneration(0),
+	m_clearedGeneration(0),
+	m_evictionTimer(0),
+	m_saveTimer(0)
+{
+	m_memoryEntries.setMaxCost(SettingsManager::getOption(SettingsManager::Cache_MemoryCacheLimitOption).toInt());
+
+	if (path.isEmpty())
+	{
+		return;
+	}
+
+	Utils::ensureDirectoryExists(path);
+
+	setCacheDirectory(path);
+	setMaximumCacheSize(SettingsManager::getOption(SettingsManager::Cache_DiskCacheLimitOption).toInt() * 1024);
+
+	const QStringList dataDirectories(QDir(cacheDirectory()).entryList({QLatin1String("data*")}, (QDir::Dirs | QDir::NoDotAndDotDot), QDir::Name));
+
+	if (!dataDirectories.isEmpty())
+	{
+		m_dataDirectory = dataDirectories.last() + QLatin1Char('/');
+	}
+
+	loadIndex();
+
+	m_writerThread = new QThread(this);
+
+	m_writer = new NetworkCacheWriter(cacheDirectory(), maximumCacheSize());
+	m_writer->moveToThread(m_writerThread);
+
+	connect(m_writerThread, &QThread::finished, m_writer, &NetworkCacheWriter::deleteLater);
+	connect(m_writer, &NetworkCacheWriter::entryWritten, this, &NetworkCache::handleEntryWritten);
+
+	m_writerThread->start(QThread::LowPriority);
+
+	scheduleEviction();
+
+	QTimer::singleShot(60000, this, [&]()
+	{
+		QSet<QString> paths;
+		paths.reserve(m_entries.count() + m_pendingWrites.count());
+
+		for (QHash<QUrl, EntryInformation>::const_iterator iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+		{
+			paths.insert(iterator.value().path);
+		}
+
+		// Files already committed by writer but not yet reported back are not orphans
+		for (QHash<QUrl, PendingWrite>::const_iterator iterator = m_pendingWrites.constBegin(); iterator != m_pendingWrites.constEnd(); ++iterator)
+		{
+			paths.insert(getFilePath(iterator.key()));
+		}
+
+		const QDateTime dateTime(QDateTime::currentDateTimeUtc());
+
+		QMetaObject::invokeMethod(m_writer, [=]()
+		{
+			m_writer->removeOrphans(paths, dateTime);
+		}, Qt::QueuedConnection);
+	});
+
+	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, [&](int identifier, const QVariant &value)
+	{
+		switch (identifier)
+		{
+			case SettingsManager::Cache_DiskCacheLimitOption:
+				setMaximumCacheSize(value.toInt() * 1024);
+
+				QMetaObject::invokeMethod(m_writer, [=]()
+				{
+					m_writer->setMaximumCacheSize(value.toInt() * 1024);
+				}, Qt::QueuedConnection);
+
+				scheduleEviction();
+
+				break;
+			case SettingsManager::Cache_MemoryCacheLimitOption:
+				m_memoryEntries.setMaxCost(value.toInt());
+
+				break;
+			default:
+				break;
+		}
+	});
+}
+
+NetworkCache::~NetworkCache()
+{
+	if (m_writerThread)
+	{
+		m_writerThread->quit();
+		m_writerThread->wait();
+	}
+
+	if (m_saveTimer != 0)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		saveIndex();
+	}
+}
+
+void NetworkCache::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_evictionTimer)
+	{
+		evictEntries();
+	}
+	else if (event->timerId() == m_saveTimer)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		saveIndex();
+	}
+}
+
+void NetworkCache::scheduleSave()
+{
+	if (Application::isAboutToQuit())
+	{
+		if (m_saveTimer != 0)
+		{
+			killTimer(m_saveTimer);
+
+			m_saveTimer = 0;
+		}
+
+		saveIndex();
+	}
+	else if (m_saveTimer == 0)
+	{
+		m_saveTimer = startTimer(1000);
+	}
+}
+
+void NetworkCache::loadIndex()
+{
+	QFile file(getIndexPath());
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		rebuildIndex();
+
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+
+	quint32 version(0);
+	quint32 amount(0);
+
+	stream >> version >> amount;
+
+	if (version < 1 || version > 3 || stream.status() != QDataStream::Ok)
+	{
+		rebuildIndex();
+
+		return;
+	}
+
+	m_entries.reserve(static_cast<int>(amount));
+
+	for (quint32 i = 0; i < amount; ++i)
+	{
+		QUrl url;
+		EntryInformation entry;
+
+		stream >> url >> entry.path >> entry.mimeType >> entry.lastModified >> entry.expirationDate >> entry.timeStored >> entry.size;
+
+		if (version > 1)
+		{
+			stream >> entry.dataSize >> entry.compressionTime;
+		}
+		else
+		{
+			entry.dataSize = entry.size;
+		}
+
+		if (version > 2)
+		{
+			stream >> entry.lastAccessed >> entry.hits;
+		}
+		else
+		{
+			entry.lastAccessed = entry.timeStored;
+		}
+
+		if (stream.status() != QDataStream::Ok)
+		{
+			m_entries.clear();
+
+			rebuildIndex();
+
+			return;
+		}
+
+		m_entries[url] = entry;
+
+		m_totalSize += entry.size;
+	}
+}
+
+void NetworkCache::rebuildIndex()
+{
+	m_entries.clear();
+
+	m_totalSize = 0;
+
+	if (m_dataDirectory.isEmpty())
+	{
+		return;
+	}
+
+	const QDir cacheDataDirectory(cacheDirectory() + m_dataDirectory);
+	const QStringList directories(cacheDataDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+
+	for (const QString &directory: directories)
+	{
+		const QStringList files(QDir(cacheDataDirectory.absoluteFilePath(directory)).entryList(QDir::Files));
+
+		for (const QString &file: files)
+		{
+			const QString path(m_dataDirectory + directory + QLatin1Char('/') + file);
+			const QNetworkCacheMetaData metaData(fileMetaData(cacheDirectory() + path));
+
+			if (metaData.isValid() && metaData.url().isValid())
+			{
+				addEntry(metaData, path);
+			}
+		}
+	}
+
+	scheduleSave();
+}
+
+void NetworkCache::saveIndex()
+{
+	if (cacheDirectory().isEmpty())
+	{
+		return;
+	}
+
+	QSaveFile file(getIndexPath());
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << static_cast<quint32>(3) << static_cast<quint32>(m_entries.count());
+
+	QHash<QUrl, EntryInformation>::const_iterator iterator;
+
+	for (iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+	{
+		const EntryInformation &entry(iterator.value());
+
+		stream << iterator.key() << entry.path << entry.mimeType << entry.lastModified << entry.expirationDate << entry.timeStored << entry.size << entry.dataSize << entry.compressionTime << entry.lastAccessed << entry.hits;
+	}
+
+	file.commit();
+}
+
+void NetworkCache::addEntry(const QNetworkCacheMetaData &metaData, const QString &path)
+{
+	const QFileInfo fileInformation(cacheDirectory() + path);
+	const QList<QPair<QByteArray, QByteArray> > headers(metaData.rawHeaders());
+	EntryInformation entry;
+	entry.path = path;
+	entry.lastModified = metaData.lastModified();
+	entry.expirationDate = metaData.expirationDate();
+	entry.timeStored = fileInformation.lastModified().toUTC();
+	entry.lastAccessed = entry.timeStored;
+	entry.size = fileInformation.size();
+	entry.dataSize = entry.size;
+
+	for (const QPair<QByteArray, QByteArray> &header: headers)
+	{
+		if (header.first.compare(QByteArrayLiteral("Content-Type"), Qt::CaseInsensitive) == 0)
+		{
+			entry.mimeType = QString::fromLatin1(header.second.split(';').first().trimmed().toLower());
+
+			break;
+		}
+	}
+
+	if (m_entries.contains(metaData.url()))
+	{
+		const EntryInformation &previousEntry(m_entries[metaData.url()]);
+
+		entry.lastAccessed = previousEntry.lastAccessed;
+		entry.hits = previousEntry.hits;
+
+		m_totalSize -= previousEntry.size;
+	}
+
+	m_entries[metaData.url()] = entry;
+
+	m_totalSize += entry.size;
+}
+
+void NetworkCache::removeEntry(const QUrl &url)
+{
+	if (m_entries.contains(url))
+	{
+		m_totalSize -= m_entries[url].size;
+
+		m_entries.remove(url);
+	}
+}
+
+void NetworkCache::cancelWrites(const QVector<QUrl> &urls)
+{
+	if (!m_writer)
+	{
+		return;
+	}
+
+	QHash<QUrl, quint64> generations;
+
+	for (const QUrl &url: urls)
+	{
+		if (m_pendingWrites.contains(url))
+		{
+			generations[url] = m_pendingWrites.take(url).lastGeneration;
+		}
+	}
+
+	if (!generations.isEmpty())
+	{
+		m_writer->cancelWrites(generations);
+	}
+}
+
+void NetworkCache::releaseDevice(QIODevice *device)
+{
+	NetworkCacheWriteBuffer *buffer(static_cast<NetworkCacheWriteBuffer*>(device));
+
+	m_bufferedSize -= buffer->size();
+
+	buffer->discard();
+
+	m_devices.remove(device);
+
+	device->deleteLater();
+}
+
+void NetworkCache::markEntryAccessed(const QUrl &url)
+{
+	if (m_entries.contains(url))
+	{
+		EntryInformation &entry(m_entries[url]);
+		entry.lastAccessed = QDateTime::currentDateTimeUtc();
+
+		++entry.hits;
+
+		scheduleSave();
+	}
+}
+
+void NetworkCache::scheduleEviction()
+{
+	if (m_evictionTimer == 0 && !cacheDirectory().isEmpty() && (!m_evictionQueue.isEmpty() || m_totalSize > maximumCacheSize()))
+	{
+		m_evictionTimer = startTimer(100);
+	}
+}
+
+void NetworkCache::evictEntries()
+{
+	if (m_evictionQueue.isEmpty())
+	{
+		if (m_totalSize <= maximumCacheSize())
+		{
+			killTimer(m_evictionTimer);
+
+			m_evictionTimer = 0;
+
+			return;
+		}
+
+		struct Candidate final
+		{
+			QUrl url;
+			qreal priority = 0;
+			bool isProtected = false;
+		};
+
+		const QSet<QString> protectedHosts(getProtectedHosts());
+		const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+		QVector<Candidate> candidates;
+		candidates.reserve(m_entries.count());
+
+		for (QHash<QUrl, EntryInformation>::const_iterator iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+		{
+			const EntryInformation &entry(iterator.value());
+			const qint64 age(qMax(qint64(1), entry.lastAccessed.secsTo(currentDateTime)));
+			int sizeClass(0);
+
+			for (qint64 size = entry.size; size > 16384 && sizeClass < 4; size /= 8)
+			{
+				++sizeClass;
+			}
+
+			Candidate candidate;
+			candidate.url = iterator.key();
+			candidate.priority = (std::log2(entry.hits + 2.0) / (static_cast<qreal>(age) * (sizeClass + 1)));
+			candidate.isProtected = protectedHosts.contains(iterator.key().host());
+
+			candidates.append(candidate);
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [&](const Candidate &first, const Candidate &second)
+		{
+			if (first.isProtected != second.isProtected)
+			{
+				return second.isProtected;
+			}
+
+			return (first.priority < second.priority);
+		});
+
+		const qint64 targetSize((maximumCacheSize() * 9) / 10);
+		qint64 size(m_totalSize);
+
+		for (int i = 0; i < candidates.count() && size > targetSize; ++i)
+		{
+			size -= m_entries.value(candidates.at(i).url).size;
+
+			m_evictionQueue.append(candidates.at(i).url);
+		}
+	}
+
+	const QVector<QUrl> urls(m_evictionQueue.mid(0, 200));
+
+	m_evictionQueue.remove(0, urls.count());
+
+	cancelWrites(urls);
+
+	for (const QUrl &url: urls)
+	{
+		removeEntry(url);
+
+		m_memoryEntries.remove(url);
+
+		emit entryRemoved(url);
+	}
+
+	QMetaObject::invokeMethod(m_writer, [=]()
+	{
+		m_writer->removeEntries(urls);
+	}, Qt::QueuedConnection);
+
+	scheduleSave();
+}
+
+void NetworkCache::clearCache(int period)
+{
+	if (period <= 0)
+	{
+		const QList<QIODevice*> devices(m_devices.keys());
+
+		for (QIODevice *device: devices)
+		{
+			releaseDevice(device);
+		}
+
+		m_pendingWrites.clear();
+
+		m_pendingWritesSize = 0;
+		m_clearedGeneration = m_writeGeneration;
+
+		if (m_writer)
+		{
+			m_writer->cancelAllWrites(m_clearedGeneration);
+		}
+
+		clear();
+
+		m_entries.clear();
+		m_memoryEntries.clear();
+		m_evictionQueue.clear();
+
+		m_totalSize = 0;
+
+		scheduleSave();
+
+		emit cleared();
+
+		return;
+	}
+
+	const QDateTime dateTime(QDateTime::currentDateTimeUtc().addSecs(-period * 3600));
+	QVector<QUrl> urls;
+	QHash<QUrl, EntryInformation>::const_iterator iterator;
+
+	for (iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+	{
+		if (iterator.value().timeStored >= dateTime)
+		{
+			urls.append(iterator.key());
+		}
+	}
+
+	for (const QUrl &url: std::as_const(urls))
+	{
+		remove(url);
+	}
+}
+
+void NetworkCache::insert(QIODevice *device)
 {
-	if (path.isEmpty())
+	if (!m_devices.contains(device))
 	{
+		QNetworkDiskCache::insert(device);
+
 		return;
 	}
 
-	Utils::ensureDirectoryExists(path);
+	const QNetworkCacheMetaData metaData(m_devices.value(device));
+	const NetworkCacheWriteBuffer *buffer(static_cast<NetworkCacheWriteBuffer*>(device));
+	const QByteArray data(buffer->data());
+	const QUrl url(metaData.url());
+	const bool isOverflowed(buffer->isOverflowed());
 
-	setCacheDirectory(path);
-	setMaximumCacheSize(SettingsManager::getOption(SettingsManager::Cache_DiskCacheLimitOption).toInt() * 1024);
+	releaseDevice(device);
 
-	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, [&](int identifier, const QVariant &value)
+	m_memoryEntries.remove(url);
+
+	if (m_lastMetaData.url() == url)
+	{
+		m_lastMetaData = {};
+	}
+
+	if (isOverflowed || (m_pendingWritesSize + data.size()) > getWriteLimit())
+	{
+		return;
+	}
+
+	addMemoryEntry(metaData, data);
+
+	const quint64 generation(++m_writeGeneration);
+	PendingWrite &pendingWrite(m_pendingWrites[url]);
+
+	if (pendingWrite.amount == 0)
+	{
+		pendingWrite.firstGeneration = generation;
+	}
+
+	pendingWrite.metaData = metaData;
+	pendingWrite.lastGeneration = generation;
+	++pendingWrite.amount;
+
+	m_pendingWritesSize += data.size();
+
+	QMetaObject::invokeMethod(m_writer, [=]()
+	{
+		m_writer->write(metaData, data, generation);
+	}, Qt::QueuedConnection);
+}
+
+QIODevice* NetworkCache::prepare(const QNetworkCacheMetaData &metaData)
+{
+	if (!m_writer || !metaData.isValid() || !metaData.url().isValid() || !metaData.saveToDisk())
+	{
+		return nullptr;
+	}
+
+	const qint64 limit(getWriteLimit());
+
+	if ((m_pendingWritesSize + m_bufferedSize) >= limit)
+	{
+		return nullptr;
+	}
+
+	const QList<QPair<QByteArray, QByteArray> > headers(metaData.rawHeaders());
+
+	for (const QPair<QByteArray, QByteArray> &header: headers)
 	{
-		if (identifier == SettingsManager::Cache_DiskCacheLimitOption)
+		if (header.first.compare(QByteArrayLiteral("Content-Length"), Qt::CaseInsensitive) == 0 && header.second.toLongLong() > limit)
 		{
-			setMaximumCacheSize(value.toInt() * 1024);
+			return nullptr;
 		}
-	});
+	}
+
+	NetworkCacheWriteBuffer *device(new NetworkCacheWriteBuffer(this, limit));
+	device->open(QIODevice::WriteOnly);
+
+	m_devices[device] = metaData;
+
+	return device;
 }
 
-void NetworkCache::clearCache(int period)
+void NetworkCache::handleEntryWritten(const QUrl &url, qint64 size, qint64 compressionTime, quint64 generation)
 {
-	if (period <= 0)
+	if (generation <= m_clearedGeneration)
 	{
-		clear();
+		return;
+	}
 
-		emit cleared();
+	m_pendingWritesSize -= size;
 
+	if (!m_pendingWrites.contains(url) || generation < m_pendingWrites[url].firstGeneration)
+	{
 		return;
 	}
 
-	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
-	const QDir cacheMainDirectory(cacheDirectory());
-	const QStringList directories(cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+	const QNetworkCacheMetaData metaData(m_pendingWrites[url].metaData);
 
-	for (const QString &directory: directories)
+	--m_pendingWrites[url].amount;
+
+	if (m_pendingWrites[url].amount <= 0)
 	{
-		const QDir cacheSubDirectory(cacheMainDirectory.absoluteFilePath(directory));
-		const QStringList subDirectories(cacheSubDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+		m_pendingWrites.remove(url);
+	}
 
-		for (const QString &subDirectory: subDirectories)
-		{
-			const QFileInfoList files(QDir(cacheSubDirectory.absoluteFilePath(subDirectory)).entryInfoList(QDir::Files));
+	const QString path(getFilePath(url));
 
-			for (const QFileInfo &file: files)
-			{
-				if (file.lastModified().toUTC().secsTo(currentDateTime) < (period * 3600))
-				{
-					const QNetworkCacheMetaData metaData(fileMetaData(file.absoluteFilePath()));
+	if (m_lastMetaData.url() == url)
+	{
+		m_lastMetaData = {};
+	}
 
-					if (metaData.isValid())
-					{
-						remove(metaData.url());
-					}
-				}
-			}
+	if (!path.isEmpty() && QFile::exists(cacheDirectory() + path))
+	{
+		// Base class keeps last read entry around, reload its header from the new file to drop old data
+		if (m_lastReadUrl == url)
+		{
+			fileMetaData(cacheDirectory() + path);
+
+			m_lastReadUrl = {};
 		}
+
+		addEntry(metaData, path);
+
+		EntryInformation &entry(m_entries[url]);
+		entry.dataSize = size;
+		entry.compressionTime = compressionTime;
+
+		scheduleSave();
+		scheduleEviction();
+
+		emit entryAdded(url);
 	}
 }
 
-void NetworkCache::insert(QIODevice *device)
+QIODevice* NetworkCache::data(const QUrl &url)
 {
-	QNetworkDiskCache::insert(device);
+	const MemoryEntry *memoryEntry(m_memoryEntries.object(url));
+
+	if (memoryEntry)
+	{
+		++m_memoryCacheHits;
+
+		markEntryAccessed(url);
+
+		QBuffer *buffer(new QBuffer());
+		buffer->setData(memoryEntry->data);
+		buffer->open(QIODevice::ReadOnly);
 
-	if (m_devices.contains(device))
+		return buffer;
+	}
+
+	++m_memoryCacheMisses;
+
+	QIODevice *device(QNetworkDiskCache::data(url));
+
+	m_lastReadUrl = url;
+
+	if (!device)
+	{
+		return nullptr;
+	}
+
+	markEntryAccessed(url);
+
+	if (m_lastMetaData.url() != url)
+	{
+		m_lastMetaData = QNetworkDiskCache::metaData(url);
+	}
+
+	const QNetworkRequest::Attribute attribute(static_cast<QNetworkRequest::Attribute>(CompressedAttribute));
+	QNetworkCacheMetaData::AttributesMap attributes(m_lastMetaData.attributes());
+
+	if (!attributes.contains(attribute))
+	{
+		addMemoryEntry(m_lastMetaData, device->readAll());
+
+		device->reset();
+
+		return device;
+	}
+
+	const QByteArray data(qUncompress(device->readAll()));
+
+	delete device;
+
+	if (data.isEmpty())
 	{
-		emit entryAdded(m_devices[device]);
+		remove(url);
 
-		m_devices.remove(device);
+		return nullptr;
 	}
+
+	QNetworkCacheMetaData metaData(m_lastMetaData);
+	attributes.remove(attribute);
+	metaData.setAttributes(attributes);
+
+	addMemoryEntry(metaData, data);
+
+	QBuffer *buffer(new QBuffer());
+	buffer->setData(data);
+	buffer->open(QIODevice::ReadOnly);
+
+	return buffer;
 }
 
-QIODevice* NetworkCache::prepare(const QNetworkCacheMetaData &metaData)
+QIODevice* NetworkCache::peekData(const QUrl &url)
 {
-	QIODevice *device(QNetworkDiskCache::prepare(metaData));
+	QIODevice *device(QNetworkDiskCache::data(url));
 
-	if (device)
+	m_lastReadUrl = url;
+
+	if (!device || !QNetworkDiskCache::metaData(url).attributes().contains(static_cast<QNetworkRequest::Attribute>(CompressedAttribute)))
 	{
-		m_devices[device] = metaData.url();
+		return device;
 	}
 
-	return device;
+	const QByteArray data(qUncompress(device->readAll()));
+
+	delete device;
+
+	if (data.isEmpty())
+	{
+		return nullptr;
+	}
+
+	QBuffer *buffer(new QBuffer());
+	buffer->setData(data);
+	buffer->open(QIODevice::ReadOnly);
+
+	return buffer;
 }
 
-QString NetworkCache::getPathForUrl(const QUrl &url)
+QNetworkCacheMetaData NetworkCache::metaData(const QUrl &url)
 {
-	if (!url.isValid() || !metaData(url).isValid())
+	const MemoryEntry *memoryEntry(m_memoryEntries.object(url));
+
+	if (memoryEntry)
 	{
-		return {};
+		return memoryEntry->metaData;
 	}
 
-	const QDir cacheMainDirectory(cacheDirectory());
-	const QStringList directories(cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+	m_lastMetaData = QNetworkDiskCache::metaData(url);
 
-	for (const QString &directory: directories)
+	QNetworkCacheMetaData metaData(m_lastMetaData);
+	QNetworkCacheMetaData::AttributesMap attributes(metaData.attributes());
+
+	if (attributes.remove(static_cast<QNetworkRequest::Attribute>(CompressedAttribute)) > 0)
 	{
-		const QDir cacheSubDirectory(cacheMainDirectory.absoluteFilePath(directory));
-		const QStringList subDirectories(cacheSubDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+		metaData.setAttributes(attributes);
+	}
 
-		for (const QString &subDirectory: subDirectories)
-		{
-			const QDir cacheFilesDirectory(cacheSubDirectory.absoluteFilePath(subDirectory));
-			const QStringList files(cacheFilesDirectory.entryList(QDir::Files));
+	return metaData;
+}
 
-			for (const QString &file: files)
-			{
-				const QString cacheFilePath(cacheFilesDirectory.absoluteFilePath(file));
-				const QNetworkCacheMetaData metaData(fileMetaData(cacheFilePath));
+QNetworkCacheMetaData NetworkCache::peekMetaData(const QUrl &url)
+{
+	QNetworkCacheMetaData metaData(QNetworkDiskCache::metaData(url));
+	QNetworkCacheMetaData::AttributesMap attributes(metaData.attributes());
 
-				if (metaData.isValid() && url == metaData.url())
-				{
-					return cacheFilePath;
-				}
-			}
-		}
+	if (attributes.remove(static_cast<QNetworkRequest::Attribute>(CompressedAttribute)) > 0)
+	{
+		metaData.setAttributes(attributes);
+	}
+
+	return metaData;
+}
+
+void NetworkCache::addMemoryEntry(const QNetworkCacheMetaData &metaData, const QByteArray &data)
+{
+	const int cost(qMax(1, static_cast<int>(data.size() / 1024)));
+
+	if (metaData.url().isValid() && cost <= (m_memoryEntries.maxCost() / 8))
+	{
+		MemoryEntry *entry(new MemoryEntry());
+		entry->metaData = metaData;
+		entry->data = data;
+
+		m_memoryEntries.insert(metaData.url(), entry, cost);
+	}
+}
+
+QString NetworkCache::getIndexPath() const
+{
+	return (cacheDirectory().isEmpty() ? QString() : cacheDirectory() + QLatin1String("index.dat"));
+}
+
+qint64 NetworkCache::getWriteLimit() const
+{
+	return qMin((16LL * 1024 * 1024), ((maximumCacheSize() * 3) / 4));
+}
+
+bool NetworkCache::reserveBufferSize(qint64 size)
+{
+	// Responses still being downloaded share write limit with writes waiting for disk
+	if ((m_pendingWritesSize + m_bufferedSize + size) > getWriteLimit())
+	{
+		return false;
+	}
+
+	m_bufferedSize += size;
+
+	return true;
+}
+
+QString NetworkCache::getFilePath(const QUrl &url) const
+{
+	if (m_dataDirectory.isEmpty() || !url.isValid())
+	{
+		return {};
+	}
+
+	// Mirrors file naming used by QNetworkDiskCache
+	QUrl cleanUrl(url);
+	cleanUrl.setPassword({});
+	cleanUrl.setFragment({});
+
+	const QByteArray hash(QCryptographicHash::hash(cleanUrl.toEncoded(), QCryptographicHash::Sha1));
+	qlonglong value(0);
+
+	std::memcpy(&value, hash.constData(), sizeof(value));
+
+	const QByteArray identifier(QByteArray::number(value, 36).left(8));
+
+	return m_dataDirectory + QString::number((static_cast<uint>(identifier.at(identifier.length() - 1)) % 16), 16) + QLatin1Char('/') + QString::fromLatin1(identifier) + QLatin1String(".d");
+}
+
+QString NetworkCache::getPathForUrl(const QUrl &url)
+{
+	if (!url.isValid() || !m_entries.contains(url))
+	{
+		return {};
+	}
+
+	const QString path(cacheDirectory() + m_entries[url].path);
+
+	if (QFile::exists(path))
+	{
+		return path;
 	}
 
+	removeEntry(url);
+
+	scheduleSave();
+
 	return {};
 }
 
+NetworkCache::EntryInformation NetworkCache::getEntry(const QUrl &url) const
+{
+	return m_entries.value(url);
+}
+
+NetworkCache::MemoryCacheStatistics NetworkCache::getMemoryCacheStatistics() const
+{
+	MemoryCacheStatistics statistics;
+	statistics.size = (static_cast<qint64>(m_memoryEntries.totalCost()) * 1024);
+	statistics.hits = m_memoryCacheHits;
+	statistics.misses = m_memoryCacheMisses;
+	statistics.amount = m_memoryEntries.count();
+
+	return statistics;
+}
+
 QVector<QUrl> NetworkCache::getEntries() const
 {
 	QVector<QUrl> entries;
-	const QDir cacheMainDirectory(cacheDirectory());
-	const QStringList directories(cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+	entries.reserve(m_entries.count());
 
-	for (const QString &directory: directories)
+	QHash<QUrl, EntryInformation>::const_iterator iterator;
+
+	for (iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+	{
+		entries.append(iterator.key());
+	}
+
+	return entries;
+}
+
+qint64 NetworkCache::expire()
+{
+	const qint64 size(QNetworkDiskCache::expire());
+
+	if (m_cacheSize >= 0 && size < m_cacheSize)
 	{
-		const QDir cacheSubDirectory(cacheMainDirectory.absoluteFilePath(directory));
-		const QStringList subDirectories(cacheSubDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+		pruneEntries();
+	}
+
+	m_cacheSize = size;
 
-		for (const QString &subDirectory: subDirectories)
+	return size;
+}
+
+void NetworkCache::pruneEntries()
+{
+	QVector<QUrl> urls;
+	QHash<QUrl, EntryInformation>::const_iterator iterator;
+
+	for (iterator = m_entries.constBegin(); iterator != m_entries.constEnd(); ++iterator)
+	{
+		if (!QFile::exists(cacheDirectory() + iterator.value().path))
 		{
-			const QDir cacheFilesDirectory(cacheSubDirectory.absoluteFilePath(subDirectory));
-			const QStringList files(cacheFilesDirectory.entryList(QDir::Files));
+			urls.append(iterator.key());
+		}
+	}
+
+	for (const QUrl &url: std::as_const(urls))
+	{
+		removeEntry(url);
+
+		m_memoryEntries.remove(url);
+
+		emit entryRemoved(url);
+	}
+
+	if (!urls.isEmpty())
+	{
+		scheduleSave();
+	}
+}
+
+QSet<QString> NetworkCache::getProtectedHosts()
+{
+	QSet<QString> hosts;
+	const BookmarksModel::Bookmark *startPageBookmark(BookmarksManager::getModel()->getBookmarkByPath(SettingsManager::getOption(SettingsManager::StartPage_BookmarksFolderOption).toString()));
 
-			entries.reserve(entries.count() + files.count());
+	if (startPageBookmark)
+	{
+		for (int i = 0; i < startPageBookmark->rowCount(); ++i)
+		{
+			const BookmarksModel::Bookmark *bookmark(startPageBookmark->getChild(i));
 
-			for (const QString &file: files)
+			if (bookmark && bookmark->getType() == BookmarksModel::UrlBookmark)
 			{
-				const QNetworkCacheMetaData metaData(fileMetaData(cacheFilesDirectory.absoluteFilePath(file)));
+				hosts.insert(bookmark->getUrl().host());
+			}
+		}
+	}
 
-				if (metaData.url().isValid())
-				{
-					entries.append(metaData.url());
-				}
+	const QVector<MainWindow*> mainWindows(Application::getWindows());
+
+	for (const MainWindow *mainWindow: mainWindows)
+	{
+		for (int i = 0; i < mainWindow->getWindowCount(); ++i)
+		{
+			const Window *window(mainWindow->getWindowByIndex(i));
+
+			if (window && window->isPinned())
+			{
+				hosts.insert(window->getUrl().host());
 			}
 		}
 	}
 
-	entries.squeeze();
+	hosts.remove({});
 
-	return entries;
+	return hosts;
+}
+
+qint64 NetworkCache::cacheSize() const
+{
+	return m_totalSize;
 }
 
 bool NetworkCache::remove(const QUrl &url)
 {
+	cancelWrites({url});
+
+	const QList<QIODevice*> devices(m_devices.keys());
+
+	for (QIODevice *device: devices)
+	{
+		if (m_devices.value(device).url() == url)
+		{
+			releaseDevice(device);
+		}
+	}
+
 	const bool result(QNetworkDiskCache::remove(url));
 
+	m_memoryEntries.remove(url);
+
+	if (m_lastMetaData.url() == url)
+	{
+		m_lastMetaData = {};
+	}
+
+	if (m_entries.contains(url))
+	{
+		removeEntry(url);
+		scheduleSave();
+	}
+
 	if (result)
 	{
 		emit entryRemoved(url);
@@ -20,32 +20,179 @@
 #ifndef OTTER_NETWORKCACHE_H
 #define OTTER_NETWORKCACHE_H
 
+#include <QtCore/QBuffer>
+#include <QtCore/QCache>
+#include <QtCore/QDateTime>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
 #include <QtNetwork/QNetworkDiskCache>
 
 namespace Otter
 {
 
+class NetworkCacheWriter final : public QNetworkDiskCache
+{
+	Q_OBJECT
+
+public:
+	explicit NetworkCacheWriter(const QString &path, qint64 maximumSize);
+
+	void write(const QNetworkCacheMetaData &metaData, const QByteArray &data, quint64 generation);
+	void cancelWrites(const QHash<QUrl, quint64> &generations);
+	void cancelAllWrites(quint64 generation);
+	void removeEntries(const QVector<QUrl> &urls);
+	void removeOrphans(const QSet<QString> &paths, const QDateTime &dateTime);
+
+protected:
+	static bool isCompressible(const QNetworkCacheMetaData &metaData);
+	qint64 expire() override;
+	bool isCancelled(const QUrl &url, quint64 generation);
+
+private:
+	QMutex m_mutex;
+	QHash<QUrl, quint64> m_cancelledWrites;
+	quint64 m_clearedGeneration;
+
+signals:
+	void entryWritten(const QUrl &url, qint64 size, qint64 compressionTime, quint64 generation);
+};
+
+class NetworkCache;
+
+class NetworkCacheWriteBuffer final : public QBuffer
+{
+public:
+	explicit NetworkCacheWriteBuffer(NetworkCache *cache, qint64 limit);
+
+	void discard();
+	bool isOverflowed() const;
+
+protected:
+	qint64 writeData(const char *data, qint64 length) override;
+
+private:
+	NetworkCache *m_cache;
+	qint64 m_limit;
+	bool m_isOverflowed;
+};
+
 class NetworkCache final : public QNetworkDiskCache
 {
 	Q_OBJECT
 
 public:
+	enum
+	{
+		CompressedAttribute = (QNetworkRequest::User + 1)
+	};
+
+	struct EntryInformation final
+	{
+		QString path;
+		QString mimeType;
+		QDateTime lastModified;
+		QDateTime expirationDate;
+		QDateTime timeStored;
+		QDateTime lastAccessed;
+		qint64 size = 0;
+		qint64 dataSize = 0;
+		qint64 compressionTime = 0;
+		quint32 hits = 0;
+	};
+
+	struct MemoryCacheStatistics final
+	{
+		qint64 size = 0;
+		qint64 hits = 0;
+		qint64 misses = 0;
+		int amount = 0;
+	};
+
 	explicit NetworkCache(const QString &path, QObject *parent = nullptr);
+	~NetworkCache();
 
 	void clearCache(int period = 0);
 	void insert(QIODevice *device) override;
 	QIODevice* prepare(const QNetworkCacheMetaData &metaData) override;
+	QIODevice* data(const QUrl &url) override;
+	QIODevice* peekData(const QUrl &url);
+	QNetworkCacheMetaData metaData(const QUrl &url) override;
+	QNetworkCacheMetaData peekMetaData(const QUrl &url);
 	QString getPathForUrl(const QUrl &url);
+	EntryInformation getEntry(const QUrl &url) const;
+	MemoryCacheStatistics getMemoryCacheStatistics() const;
 	QVector<QUrl> getEntries() const;
+	qint64 cacheSize() const override;
 	bool remove(const QUrl &url) override;
 
+protected:
+	void timerEvent(QTimerEvent *event) override;
+	void scheduleSave();
+	void loadIndex();
+	void rebuildIndex();
+	void saveIndex();
+	void addEntry(const QNetworkCacheMetaData &metaData, const QString &path);
+	void addMemoryEntry(const QNetworkCacheMetaData &metaData, const QByteArray &data);
+	void removeEntry(const QUrl &url);
+	void cancelWrites(const QVector<QUrl> &urls);
+	void releaseDevice(QIODevice *device);
+	void markEntryAccessed(const QUrl &url);
+	void pruneEntries();
+	void scheduleEviction();
+	void evictEntries();
+	QString getIndexPath() const;
+	QString getFilePath(const QUrl &url) const;
+	static QSet<QString> getProtectedHosts();
+	qint64 getWriteLimit() const;
+	qint64 expire() override;
+	bool reserveBufferSize(qint64 size);
+
+protected slots:
+	void handleEntryWritten(const QUrl &url, qint64 size, qint64 compressionTime, quint64 generation);
+
 private:
-	QHash<QIODevice*, QUrl> m_devices;
+	struct MemoryEntry final
+	{
+		QNetworkCacheMetaData metaData;
+		QByteArray data;
+	};
+
+	struct PendingWrite final
+	{
+		QNetworkCacheMetaData metaData;
+		quint64 firstGeneration = 0;
+		quint64 lastGeneration = 0;
+		int amount = 0;
+	};
+
+	NetworkCacheWriter *m_writer;
+	QThread *m_writerThread;
+	QString m_dataDirectory;
+	QNetworkCacheMetaData m_lastMetaData;
+	QUrl m_lastReadUrl;
+	QCache<QUrl, MemoryEntry> m_memoryEntries;
+	QHash<QIODevice*, QNetworkCacheMetaData> m_devices;
+	QHash<QUrl, PendingWrite> m_pendingWrites;
+	QHash<QUrl, EntryInformation> m_entries;
+	QVector<QUrl> m_evictionQueue;
+	qint64 m_memoryCacheHits;
+	qint64 m_memoryCacheMisses;
+	qint64 m_pendingWritesSize;
+	qint64 m_bufferedSize;
+	qint64 m_cacheSize;
+	qint64 m_totalSize;
+	quint64 m_writeGeneration;
+	quint64 m_clearedGeneration;
+	int m_evictionTimer;
+	int m_saveTimer;
 
 signals:
 	void cleared();
 	void entryAdded(const QUrl &url);
 	void entryRemoved(const QUrl &url);
+
+friend class NetworkCacheWriteBuffer;
 };
 
 }
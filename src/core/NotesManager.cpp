@@ -50,7 +50,7 @@ void NotesManager::timerEvent(QTimerEvent *event)
 
 		if (m_model)
 		{
-			m_model->save(SessionsManager::getWritableDataPath(QLatin1String("notes.xbel")));
+			m_model->compact();
 		}
 	}
 }
@@ -68,7 +68,7 @@ void NotesManager::scheduleSave()
 
 		if (m_model)
 		{
-			m_model->save(SessionsManager::getWritableDataPath(QLatin1String("notes.xbel")));
+			m_model->compact(false);
 		}
 	}
 	else if (m_saveTimer == 0)
@@ -23,7 +23,10 @@
 #include "SettingsManager.h"
 #include "ThemesManager.h"
 
+#include <QtCore/QDataStream>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QXmlStreamWriter>
 #include <QtNetwork/QNetworkRequest>
@@ -36,6 +39,7 @@ QStandardItemModel* SearchEnginesManager::m_searchEnginesModel(nullptr);
 QStringList SearchEnginesManager::m_searchEnginesOrder;
 QStringList SearchEnginesManager::m_searchKeywords;
 QHash<QString, SearchEnginesManager::SearchEngineDefinition> SearchEnginesManager::m_searchEngines;
+QHash<QString, QString> SearchEnginesManager::m_searchKeywordsIdentifiers;
 bool SearchEnginesManager::m_isInitialized(false);
 
 SearchEnginesManager::SearchEnginesManager(QObject *parent) : QObject(parent)
@@ -72,45 +76,188 @@ void SearchEnginesManager::loadSearchEngines()
 {
 	m_searchEnginesOrder = SettingsManager::getOption(SettingsManager::Search_SearchEnginesOrderOption).toStringList();
 
-	m_searchEngines.clear();
-	m_searchEngines.reserve(m_searchEnginesOrder.count());
+	const QString stamp(createSnapshotStamp(m_searchEnginesOrder));
 
-	m_searchKeywords.clear();
-	m_searchKeywords.reserve(m_searchEnginesOrder.count());
+	if (!loadSnapshot(stamp))
+	{
+		m_searchEngines.clear();
+		m_searchEngines.reserve(m_searchEnginesOrder.count());
 
-	const QStringList searchEnginesOrder(m_searchEnginesOrder);
+		m_searchKeywords.clear();
+		m_searchKeywords.reserve(m_searchEnginesOrder.count());
 
-	for (const QString &identifier: searchEnginesOrder)
-	{
-		QFile file(SessionsManager::getReadableDataPath(QLatin1String("searchEngines/") + identifier + QLatin1String(".xml")));
+		const QStringList searchEnginesOrder(m_searchEnginesOrder);
 
-		if (!file.open(QIODevice::ReadOnly))
+		for (const QString &identifier: searchEnginesOrder)
 		{
-			m_searchEnginesOrder.removeAll(identifier);
+			QFile file(SessionsManager::getReadableDataPath(QLatin1String("searchEngines/") + identifier + QLatin1String(".xml")));
+
+			if (!file.open(QIODevice::ReadOnly))
+			{
+				m_searchEnginesOrder.removeAll(identifier);
+
+				continue;
+			}
+
+			const SearchEngineDefinition searchEngine(loadSearchEngine(&file, identifier, true));
 
-			continue;
+			file.close();
+
+			if (searchEngine.isValid())
+			{
+				m_searchEngines[identifier] = searchEngine;
+			}
+			else
+			{
+				m_searchEnginesOrder.removeAll(identifier);
+			}
 		}
 
-		const SearchEngineDefinition searchEngine(loadSearchEngine(&file, identifier, true));
+		m_searchEngines.squeeze();
+
+		saveSnapshot(stamp);
+	}
 
-		file.close();
+	updateSearchKeywords();
 
-		if (searchEngine.isValid())
+	emit m_instance->searchEnginesModified();
+
+	updateSearchEnginesModel();
+	updateSearchEnginesOptions();
+}
+
+void SearchEnginesManager::updateSearchKeywords()
+{
+	m_searchKeywordsIdentifiers.clear();
+	m_searchKeywordsIdentifiers.reserve(m_searchEngines.count());
+
+	for (const QString &identifier: std::as_const(m_searchEnginesOrder))
+	{
+		const QString keyword(m_searchEngines.value(identifier).keyword);
+
+		if (!keyword.isEmpty() && !m_searchKeywordsIdentifiers.contains(keyword))
 		{
-			m_searchEngines[identifier] = searchEngine;
+			m_searchKeywordsIdentifiers[keyword] = identifier;
 		}
-		else
+	}
+
+	QHash<QString, SearchEngineDefinition>::const_iterator iterator;
+
+	for (iterator = m_searchEngines.constBegin(); iterator != m_searchEngines.constEnd(); ++iterator)
+	{
+		if (!iterator.value().keyword.isEmpty() && !m_searchKeywordsIdentifiers.contains(iterator.value().keyword))
 		{
-			m_searchEnginesOrder.removeAll(identifier);
+			m_searchKeywordsIdentifiers[iterator.value().keyword] = iterator.key();
 		}
 	}
+}
 
-	m_searchEngines.squeeze();
+void SearchEnginesManager::saveSnapshot(const QString &stamp)
+{
+	if (SessionsManager::isReadOnly())
+	{
+		return;
+	}
 
-	emit m_instance->searchEnginesModified();
+	QSaveFile file(SessionsManager::getWritableDataPath(QLatin1String("searchEngines.dat")));
 
-	updateSearchEnginesModel();
-	updateSearchEnginesOptions();
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << static_cast<quint32>(1) << stamp << m_searchEnginesOrder << m_searchKeywords << static_cast<quint32>(m_searchEnginesOrder.count());
+
+	for (const QString &identifier: std::as_const(m_searchEnginesOrder))
+	{
+		const SearchEngineDefinition searchEngine(m_searchEngines.value(identifier));
+
+		stream << searchEngine.identifier << searchEngine.title << searchEngine.description << searchEngine.keyword << searchEngine.encoding << searchEngine.formUrl << searchEngine.iconUrl << searchEngine.selfUrl << searchEngine.icon;
+
+		for (const SearchUrl &searchUrl: {searchEngine.resultsUrl, searchEngine.suggestionsUrl})
+		{
+			stream << searchUrl.url << searchUrl.enctype << searchUrl.method << searchUrl.parameters.query(QUrl::FullyEncoded);
+		}
+	}
+
+	file.commit();
+}
+
+QString SearchEnginesManager::createSnapshotStamp(const QStringList &identifiers)
+{
+	QStringList stamp({QCoreApplication::applicationVersion(), QString::number(QFileInfo(SessionsManager::getWritableDataPath(QLatin1String("searchEngines"))).lastModified().toMSecsSinceEpoch()), QString::number(QFileInfo(SessionsManager::getReadableDataPath(QLatin1String("searchEngines/"), true)).lastModified().toMSecsSinceEpoch())});
+	stamp.reserve(identifiers.count() + 3);
+
+	for (const QString &identifier: identifiers)
+	{
+		const QFileInfo information(SessionsManager::getReadableDataPath(QLatin1String("searchEngines/") + identifier + QLatin1String(".xml")));
+
+		stamp.append(QStringLiteral("%1:%2:%3:%4").arg(identifier, information.filePath()).arg(information.size()).arg(information.lastModified().toMSecsSinceEpoch()));
+	}
+
+	return stamp.join(QLatin1Char('\n'));
+}
+
+bool SearchEnginesManager::loadSnapshot(const QString &stamp)
+{
+	QFile file(SessionsManager::getWritableDataPath(QLatin1String("searchEngines.dat")));
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+
+	quint32 version(0);
+	quint32 amount(0);
+	QString snapshotStamp;
+	QStringList searchEnginesOrder;
+	QStringList searchKeywords;
+
+	stream >> version >> snapshotStamp;
+
+	if (version != 1 || snapshotStamp != stamp)
+	{
+		return false;
+	}
+
+	stream >> searchEnginesOrder >> searchKeywords >> amount;
+
+	QHash<QString, SearchEngineDefinition> searchEngines;
+	searchEngines.reserve(static_cast<int>(amount));
+
+	for (quint32 i = 0; i < amount; ++i)
+	{
+		SearchEngineDefinition searchEngine;
+
+		stream >> searchEngine.identifier >> searchEngine.title >> searchEngine.description >> searchEngine.keyword >> searchEngine.encoding >> searchEngine.formUrl >> searchEngine.iconUrl >> searchEngine.selfUrl >> searchEngine.icon;
+
+		for (SearchUrl *searchUrl: {&searchEngine.resultsUrl, &searchEngine.suggestionsUrl})
+		{
+			QString parameters;
+
+			stream >> searchUrl->url >> searchUrl->enctype >> searchUrl->method >> parameters;
+
+			searchUrl->parameters = QUrlQuery(parameters);
+		}
+
+		if (stream.status() != QDataStream::Ok || !searchEngine.isValid())
+		{
+			return false;
+		}
+
+		searchEngines[searchEngine.identifier] = searchEngine;
+	}
+
+	m_searchEnginesOrder = searchEnginesOrder;
+	m_searchKeywords = searchKeywords;
+	m_searchEngines = searchEngines;
+
+	return true;
 }
 
 void SearchEnginesManager::updateSearchEnginesModel()
@@ -414,20 +561,12 @@ SearchEnginesManager::SearchEngineDefinition SearchEnginesManager::getSearchEngi
 
 	if (byKeyword)
 	{
-		if (!identifier.isEmpty())
+		if (identifier.isEmpty() || !m_searchKeywordsIdentifiers.contains(identifier))
 		{
-			QHash<QString, SearchEngineDefinition>::iterator iterator;
-
-			for (iterator = m_searchEngines.begin(); iterator != m_searchEngines.end(); ++iterator)
-			{
-				if (iterator.value().keyword == identifier)
-				{
-					return iterator.value();
-				}
-			}
+			return {};
 		}
 
-		return {};
+		return m_searchEngines.value(m_searchKeywordsIdentifiers[identifier], {});
 	}
 
 	if (identifier.isEmpty())
@@ -446,6 +585,8 @@ SearchEnginesManager::SearchEngineDefinition SearchEnginesManager::getSearchEngi
 			if (searchEngine.isValid())
 			{
 				m_searchEngines[identifier] = searchEngine;
+
+				updateSearchKeywords();
 			}
 
 			file.close();
@@ -629,6 +770,27 @@ bool SearchEnginesManager::saveSearchEngine(const SearchEngineDefinition &search
 	writer.writeEndElement();
 	writer.writeEndDocument();
 
+	if (m_isInitialized && m_searchEngines.contains(identifier))
+	{
+		const QString previousKeyword(m_searchEngines[identifier].keyword);
+		SearchEngineDefinition definition(searchEngine);
+		definition.identifier = identifier;
+
+		m_searchEngines[identifier] = definition;
+
+		updateSearchKeywords();
+
+		if (!previousKeyword.isEmpty() && !m_searchKeywordsIdentifiers.contains(previousKeyword))
+		{
+			m_searchKeywords.removeAll(previousKeyword);
+		}
+
+		if (!definition.keyword.isEmpty() && !m_searchKeywords.contains(definition.keyword))
+		{
+			m_searchKeywords.append(definition.keyword);
+		}
+	}
+
 	return true;
 }
 
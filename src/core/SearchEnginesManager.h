@@ -108,6 +108,10 @@ protected:
 	static void ensureInitialized();
 	static void updateSearchEnginesModel();
 	static void updateSearchEnginesOptions();
+	static void updateSearchKeywords();
+	static void saveSnapshot(const QString &stamp);
+	static QString createSnapshotStamp(const QStringList &identifiers);
+	static bool loadSnapshot(const QString &stamp);
 
 private:
 	static SearchEnginesManager *m_instance;
@@ -115,6 +119,7 @@ private:
 	static QStringList m_searchEnginesOrder;
 	static QStringList m_searchKeywords;
 	static QHash<QString, SearchEngineDefinition> m_searchEngines;
+	static QHash<QString, QString> m_searchKeywordsIdentifiers;
 	static bool m_isInitialized;
 
 signals:
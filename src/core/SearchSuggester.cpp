@@ -22,9 +22,11 @@
 #include "NetworkManager.h"
 #include "NetworkManagerFactory.h"
 #include "SearchEnginesManager.h"
+#include "SettingsManager.h"
 
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
+#include <QtCore/QTimerEvent>
 
 namespace Otter
 {
@@ -32,10 +34,24 @@ namespace Otter
 SearchSuggester::SearchSuggester(const QString &searchEngine, QObject *parent) : QObject(parent),
 	m_networkReply(nullptr),
 	m_model(nullptr),
-	m_searchEngine(searchEngine)
+	m_searchEngine(searchEngine),
+	m_cache(100),
+	m_requestTimer(0)
 {
 }
 
+void SearchSuggester::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_requestTimer)
+	{
+		killTimer(m_requestTimer);
+
+		m_requestTimer = 0;
+
+		sendRequest();
+	}
+}
+
 void SearchSuggester::setSearchEngine(const QString &searchEngine)
 {
 	const QString query(m_query);
@@ -54,7 +70,13 @@ void SearchSuggester::setQuery(const QString &query)
 	}
 
 	m_query = query;
-	m_suggestions.clear();
+
+	if (m_requestTimer != 0)
+	{
+		killTimer(m_requestTimer);
+
+		m_requestTimer = 0;
+	}
 
 	if (m_networkReply)
 	{
@@ -63,6 +85,58 @@ void SearchSuggester::setQuery(const QString &query)
 		m_networkReply = nullptr;
 	}
 
+	if (query.isEmpty())
+	{
+		setSuggestions({});
+
+		return;
+	}
+
+	const QVector<SearchSuggestion> *cachedSuggestions(m_cache.object({m_searchEngine, query}));
+
+	if (cachedSuggestions)
+	{
+		setSuggestions(*cachedSuggestions);
+
+		return;
+	}
+
+	QVector<SearchSuggestion> suggestions;
+
+	for (int i = (query.length() - 1); i > 0; --i)
+	{
+		const QVector<SearchSuggestion> *prefixSuggestions(m_cache.object({m_searchEngine, query.left(i)}));
+
+		if (prefixSuggestions)
+		{
+			for (const SearchSuggestion &suggestion: std::as_const(*prefixSuggestions))
+			{
+				if (suggestion.completion.startsWith(query, Qt::CaseInsensitive))
+				{
+					suggestions.append(suggestion);
+				}
+			}
+
+			break;
+		}
+	}
+
+	setSuggestions(suggestions);
+
+	const int delay(SettingsManager::getOption(SettingsManager::Search_SearchEnginesSuggestionsDelayOption).toInt());
+
+	if (delay > 0)
+	{
+		m_requestTimer = startTimer(delay);
+	}
+	else
+	{
+		sendRequest();
+	}
+}
+
+void SearchSuggester::sendRequest()
+{
 	const SearchEnginesManager::SearchEngineDefinition searchEngine(SearchEnginesManager::getSearchEngine(m_searchEngine));
 
 	if (!searchEngine.isValid() || searchEngine.suggestionsUrl.url.isEmpty())
@@ -70,7 +144,7 @@ void SearchSuggester::setQuery(const QString &query)
 		return;
 	}
 
-	SearchEnginesManager::SearchQuery searchQuery(SearchEnginesManager::setupQuery(query, searchEngine.suggestionsUrl));
+	SearchEnginesManager::SearchQuery searchQuery(SearchEnginesManager::setupQuery(m_query, searchEngine.suggestionsUrl));
 	searchQuery.request.setHeader(QNetworkRequest::UserAgentHeader, NetworkManagerFactory::getUserAgent());
 
 	if (searchQuery.method == QNetworkAccessManager::PostOperation)
@@ -89,11 +163,6 @@ void SearchSuggester::setQuery(const QString &query)
 			return;
 		}
 
-		if (m_model)
-		{
-			m_model->clear();
-		}
-
 		m_networkReply->deleteLater();
 
 		if (m_networkReply->size() <= 0)
@@ -115,8 +184,8 @@ void SearchSuggester::setQuery(const QString &query)
 		const QJsonArray completionsArray(document.array().at(1).toArray());
 		const QJsonArray descriptionsArray(document.array().at(2).toArray());
 		const QJsonArray urlsArray(document.array().at(3).toArray());
-
-		m_suggestions.reserve(completionsArray.count());
+		QVector<SearchSuggestion> suggestions;
+		suggestions.reserve(completionsArray.count());
 
 		for (int i = 0; i < completionsArray.count(); ++i)
 		{
@@ -125,18 +194,32 @@ void SearchSuggester::setQuery(const QString &query)
 			suggestion.description = descriptionsArray.at(i).toString();
 			suggestion.url = urlsArray.at(i).toString();
 
-			m_suggestions.append(suggestion);
-
-			if (m_model)
-			{
-				m_model->appendRow(new QStandardItem(suggestion.completion));
-			}
+			suggestions.append(suggestion);
 		}
 
-		emit suggestionsChanged(m_suggestions);
+		m_cache.insert({m_searchEngine, m_query}, new QVector<SearchSuggestion>(suggestions));
+
+		setSuggestions(suggestions);
 	});
 }
 
+void SearchSuggester::setSuggestions(const QVector<SearchSuggestion> &suggestions)
+{
+	m_suggestions = suggestions;
+
+	if (m_model)
+	{
+		m_model->clear();
+
+		for (const SearchSuggestion &suggestion: suggestions)
+		{
+			m_model->appendRow(new QStandardItem(suggestion.completion));
+		}
+	}
+
+	emit suggestionsChanged(m_suggestions);
+}
+
 QStandardItemModel* SearchSuggester::getModel()
 {
 	if (!m_model)
@@ -21,6 +21,7 @@
 #ifndef OTTER_SEARCHSUGGESTER_H
 #define OTTER_SEARCHSUGGESTER_H
 
+#include <QtCore/QCache>
 #include <QtCore/QObject>
 #include <QtGui/QStandardItemModel>
 #include <QtNetwork/QNetworkReply>
@@ -49,12 +50,19 @@ public slots:
 	void setSearchEngine(const QString &searchEngine);
 	void setQuery(const QString &query);
 
+protected:
+	void timerEvent(QTimerEvent *event) override;
+	void sendRequest();
+	void setSuggestions(const QVector<SearchSuggestion> &suggestions);
+
 private:
 	QNetworkReply *m_networkReply;
 	QStandardItemModel *m_model;
 	QString m_searchEngine;
 	QString m_query;
+	QCache<QPair<QString, QString>, QVector<SearchSuggestion> > m_cache;
 	QVector<SearchSuggestion> m_suggestions;
+	int m_requestTimer;
 
 signals:
 	void suggestionsChanged(const QVector<SearchSuggester::SearchSuggestion> &suggestions);
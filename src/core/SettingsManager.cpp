@@ -63,6 +63,7 @@ void SettingsManager::createInstance(const QString &path)
 	registerOption(AddressField_DropActionOption, EnumerationType, QLatin1String("replace"), {QLatin1String("replace"), QLatin1String("paste"), QLatin1String("pasteAndGo")});
 	registerOption(AddressField_HostLookupTimeoutOption, IntegerType, 200);
 	registerOption(AddressField_LayoutOption, ListType, QStringList({QLatin1String("websiteInformation"), QLatin1String("address"), QLatin1String("fillPassword"), QLatin1String("loadPlugins"), QLatin1String("listFeeds"), QLatin1String("bookmark"), QLatin1String("historyDropdown")}));
+	registerOption(AddressField_LogCompletionLatencyOption, BooleanType, false);
 	registerOption(AddressField_PasteAndGoOnMiddleClickOption, BooleanType, true);
 	registerOption(AddressField_SelectAllOnFocusOption, BooleanType, false);
 	registerOption(AddressField_ShowCompletionCategoriesOption, BooleanType, true);
@@ -100,6 +101,7 @@ void SettingsManager::createInstance(const QString &path)
 	registerOption(Browser_TransferStartingActionOption, EnumerationType, QLatin1String("doNothing"), {QLatin1String("openTab"), QLatin1String("openBackgroundTab"), QLatin1String("openPanel"), QLatin1String("doNothing")});
 	registerOption(Browser_ValidatorsOrderOption, ListType, QStringList({QLatin1String("w3c-markup"), QLatin1String("w3c-css")}));
 	registerOption(Cache_DiskCacheLimitOption, IntegerType, 51200);
+	registerOption(Cache_MemoryCacheLimitOption, IntegerType, 10240);
 	registerOption(Cache_PagesInMemoryLimitOption, IntegerType, 5);
 	registerOption(Choices_WarnFormResendOption, BooleanType, true);
 	registerOption(Choices_WarnLowDiskSpaceOption, EnumerationType, QLatin1String("warn"), {QLatin1String("warn"), QLatin1String("continueReadOnly"), QLatin1String("continueReadWrite")});
@@ -202,6 +204,7 @@ void SettingsManager::createInstance(const QString &path)
 	registerOption(Search_EnableFindInPageHighlightAllOption, BooleanType, false);
 	registerOption(Search_ReuseLastQuickFindQueryOption, BooleanType, false);
 	registerOption(Search_SearchEnginesOrderOption, ListType, QStringList({QLatin1String("duckduckgo"), QLatin1String("wikipedia"), QLatin1String("startpage"), QLatin1String("google"), QLatin1String("yahoo"), QLatin1String("bing"), QLatin1String("youtube")}));
+	registerOption(Search_SearchEnginesSuggestionsDelayOption, IntegerType, 150);
 	registerOption(Search_SearchEnginesSuggestionsModeOption, EnumerationType, QLatin1String("nonPrivateTabsOnly"), QStringList({QLatin1String("enabled"), QLatin1String("nonPrivateTabsOnly"), QLatin1String("disabled")}));
 	registerOption(Security_AllowMixedContentOption, BooleanType, false);
 	registerOption(Security_CiphersOption, ListType, QStringList(QLatin1String("default")));
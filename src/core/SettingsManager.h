@@ -42,6 +42,7 @@ public:
 		AddressField_DropActionOption,
 		AddressField_HostLookupTimeoutOption,
 		AddressField_LayoutOption,
+		AddressField_LogCompletionLatencyOption,
 		AddressField_PasteAndGoOnMiddleClickOption,
 		AddressField_SelectAllOnFocusOption,
 		AddressField_ShowCompletionCategoriesOption,
@@ -79,6 +80,7 @@ public:
 		Browser_TransferStartingActionOption,
 		Browser_ValidatorsOrderOption,
 		Cache_DiskCacheLimitOption,
+		Cache_MemoryCacheLimitOption,
 		Cache_PagesInMemoryLimitOption,
 		Choices_WarnFormResendOption,
 		Choices_WarnLowDiskSpaceOption,
@@ -181,6 +183,7 @@ public:
 		Search_EnableFindInPageHighlightAllOption,
 		Search_ReuseLastQuickFindQueryOption,
 		Search_SearchEnginesOrderOption,
+		Search_SearchEnginesSuggestionsDelayOption,
 		Search_SearchEnginesSuggestionsModeOption,
 		Security_AllowMixedContentOption,
 		Security_CiphersOption,
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2017 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2026 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -19,38 +19,179 @@
 
 #include "QtWebKitHistoryInterface.h"
 #include "../../../../core/HistoryManager.h"
+#include "../../../../core/Utils.h"
+
+#include <QtCore/QTimerEvent>
 
 namespace Otter
 {
 
-QtWebKitHistoryInterface::QtWebKitHistoryInterface(QObject *parent) : QWebHistoryInterface(parent)
+QtWebKitHistoryInterface::QtWebKitHistoryInterface(QObject *parent) : QWebHistoryInterface(parent),
+	m_rebuildTimer(0)
 {
-	connect(HistoryManager::getBrowsingHistoryModel(), &HistoryModel::cleared, this, &QtWebKitHistoryInterface::clear);
+	const HistoryModel *model(HistoryManager::getBrowsingHistoryModel());
+
+	rebuild();
+
+	connect(model, &HistoryModel::cleared, this, &QtWebKitHistoryInterface::clear);
+	connect(model, &HistoryModel::entryAdded, this, &QtWebKitHistoryInterface::handleEntryChanged);
+	connect(model, &HistoryModel::entryModified, this, &QtWebKitHistoryInterface::handleEntryChanged);
+	connect(model, &HistoryModel::entryRemoved, this, &QtWebKitHistoryInterface::scheduleRebuild);
+	connect(model, &HistoryModel::entriesRemoved, this, &QtWebKitHistoryInterface::scheduleRebuild);
+	connect(model, &HistoryModel::urlsRemoved, this, &QtWebKitHistoryInterface::handleUrlsRemoved);
+}
+
+void QtWebKitHistoryInterface::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_rebuildTimer)
+	{
+		killTimer(m_rebuildTimer);
+
+		m_rebuildTimer = 0;
+
+		rebuild();
+	}
 }
 
 void QtWebKitHistoryInterface::clear()
 {
-	m_urls.clear();
+	m_visitedLinks.clear();
+	m_removedLinks.clear();
+	m_sessionLinks.clear();
+}
+
+void QtWebKitHistoryInterface::rebuild()
+{
+	const HistoryModel *model(HistoryManager::getBrowsingHistoryModel());
+
+	for (int i = (m_sessionLinks.count() - 1); i >= 0; --i)
+	{
+		if (m_removedLinks.contains(m_sessionLinks.at(i)))
+		{
+			m_sessionLinks.removeAt(i);
+		}
+	}
+
+	m_removedLinks.clear();
+
+	m_visitedLinks = QSet<quint64>(m_sessionLinks.constBegin(), m_sessionLinks.constEnd());
+	m_visitedLinks.reserve(m_sessionLinks.count() + (model->rowCount() * 2));
+
+	for (int i = 0; i < model->rowCount(); ++i)
+	{
+		const HistoryModel::Entry *entry(static_cast<HistoryModel::Entry*>(model->item(i)));
+
+		if (entry)
+		{
+			addUrl(entry->getUrl());
+		}
+	}
+}
+
+void QtWebKitHistoryInterface::scheduleRebuild()
+{
+	if (m_rebuildTimer == 0)
+	{
+		m_rebuildTimer = startTimer(500);
+	}
+}
+
+void QtWebKitHistoryInterface::addUrl(const QUrl &url)
+{
+	if (!url.isValid())
+	{
+		return;
+	}
+
+	const QVector<quint64> keys(createKeys(url));
+
+	for (const quint64 key: keys)
+	{
+		m_visitedLinks.insert(key);
+	}
 }
 
 void QtWebKitHistoryInterface::addHistoryEntry(const QString &url)
 {
-	if (m_urls.contains(url))
+	const quint64 key(createKey(url));
+
+	m_removedLinks.remove(key);
+	m_visitedLinks.insert(key);
+
+	if (m_sessionLinks.contains(key))
 	{
 		return;
 	}
 
-	m_urls.append(url);
+	m_sessionLinks.append(key);
+
+	if (m_sessionLinks.count() > 100)
+	{
+		m_sessionLinks.removeFirst();
+	}
+}
+
+void QtWebKitHistoryInterface::handleEntryChanged(HistoryModel::Entry *entry)
+{
+	if (entry)
+	{
+		addUrl(entry->getUrl());
+	}
+}
+
+void QtWebKitHistoryInterface::handleUrlsRemoved(const QVector<QUrl> &urls)
+{
+	for (const QUrl &url: urls)
+	{
+		if (url.isValid())
+		{
+			const QVector<quint64> keys(createKeys(url));
+
+			for (const quint64 key: keys)
+			{
+				m_removedLinks.insert(key);
+			}
+		}
+	}
+
+	scheduleRebuild();
+}
+
+QVector<quint64> QtWebKitHistoryInterface::createKeys(const QUrl &url)
+{
+	const QUrl normalizedUrl(Utils::normalizeUrl(url));
+
+	return {createKey(normalizedUrl.toString()), createKey(normalizedUrl.toString(QUrl::FullyEncoded)), createKey(url.toString(QUrl::FullyEncoded))};
+}
+
+quint64 QtWebKitHistoryInterface::createKey(const QString &url)
+{
+	int length(url.indexOf(QLatin1Char('#')));
 
-	if (m_urls.length() > 100)
+	if (length < 0)
 	{
-		m_urls.removeAt(0);
+		length = url.length();
 	}
+
+	while (length > 0 && url.at(length - 1) == QLatin1Char('/'))
+	{
+		--length;
+	}
+
+	quint64 key(14695981039346656037ULL);
+
+	for (int i = 0; i < length; ++i)
+	{
+		key ^= url.at(i).unicode();
+		key *= 1099511628211ULL;
+	}
+
+	return key;
 }
 
 bool QtWebKitHistoryInterface::historyContains(const QString &url) const
 {
-	return (m_urls.contains(url) || HistoryManager::hasEntry(url));
+	return (HistoryManager::isEnabled() && m_visitedLinks.contains(createKey(url)));
 }
 
 }
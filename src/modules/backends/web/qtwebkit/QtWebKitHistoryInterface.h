@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2017 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2026 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -20,7 +20,9 @@
 #ifndef OTTER_QTWEBKITHISTORYINTERFACE_H
 #define OTTER_QTWEBKITHISTORYINTERFACE_H
 
-#include <QtCore/QStringList>
+#include "../../../../core/HistoryModel.h"
+
+#include <QtCore/QSet>
 #include <QtWebKit/QWebHistoryInterface>
 
 namespace Otter
@@ -36,11 +38,24 @@ public:
 	void addHistoryEntry(const QString &url) override;
 	bool historyContains(const QString &url) const override;
 
+protected:
+	void timerEvent(QTimerEvent *event) override;
+	void addUrl(const QUrl &url);
+	static QVector<quint64> createKeys(const QUrl &url);
+	static quint64 createKey(const QString &url);
+
 protected slots:
 	void clear();
+	void rebuild();
+	void handleEntryChanged(HistoryModel::Entry *entry);
+	void handleUrlsRemoved(const QVector<QUrl> &urls);
+	void scheduleRebuild();
 
 private:
-	QStringList m_urls;
+	QSet<quint64> m_visitedLinks;
+	QSet<quint64> m_removedLinks;
+	QVector<quint64> m_sessionLinks;
+	int m_rebuildTimer;
 };
 
 }
@@ -46,6 +46,7 @@ int QtWebKitWebBackend::m_enableMediaOption(-1);
 int QtWebKitWebBackend::m_enableMediaSourceOption(-1);
 int QtWebKitWebBackend::m_enableSiteSpecificQuirksOption(-1);
 int QtWebKitWebBackend::m_enableWebSecurityOption(-1);
+QVector<QPointer<QtWebKitPage> > QtWebKitWebPageThumbnailJob::m_pages;
 
 QtWebKitWebBackend::QtWebKitWebBackend(QObject *parent) : WebBackend(parent),
 	m_isInitialized(false)
@@ -517,29 +518,66 @@ QtWebKitWebPageThumbnailJob::QtWebKitWebPageThumbnailJob(const QUrl &url, const
 
 void QtWebKitWebPageThumbnailJob::start()
 {
-	if (!m_page)
+	if (m_page)
 	{
-		m_page = new QtWebKitPage(m_url);
-		m_page->setParent(this);
+		return;
+	}
 
-		connect(m_page, &QtWebKitPage::loadFinished, this, &QtWebKitWebPageThumbnailJob::handlePageLoadFinished);
+	while (!m_pages.isEmpty() && !m_page)
+	{
+		m_page = m_pages.takeLast();
+	}
+
+	if (m_page)
+	{
+		m_page->getNetworkManager()->updateOptions(m_url);
+		m_page->setViewportSize({});
+		m_page->mainFrame()->setUrl(m_url);
 	}
+	else
+	{
+		m_page = new QtWebKitPage(m_url);
+		m_page->setParent(parent());
+	}
+
+	connect(m_page, &QtWebKitPage::loadFinished, this, &QtWebKitWebPageThumbnailJob::handlePageLoadFinished);
 }
 
 void QtWebKitWebPageThumbnailJob::cancel()
 {
-	if (m_page)
+	releasePage();
+
+	deleteLater();
+}
+
+void QtWebKitWebPageThumbnailJob::releasePage()
+{
+	if (!m_page)
 	{
-		m_page->triggerAction(QWebPage::Stop);
+		return;
 	}
 
-	deleteLater();
+	disconnect(m_page, &QtWebKitPage::loadFinished, this, &QtWebKitWebPageThumbnailJob::handlePageLoadFinished);
+
+	m_page->triggerAction(QWebPage::Stop);
+
+	if (m_pages.count() < 3)
+	{
+		m_pages.append(m_page);
+	}
+	else
+	{
+		m_page->deleteLater();
+	}
+
+	m_page = nullptr;
 }
 
 void QtWebKitWebPageThumbnailJob::handlePageLoadFinished(bool result)
 {
 	if (!result)
 	{
+		releasePage();
 		deleteLater();
 
 		emit jobFinished(false);
@@ -560,6 +598,11 @@ void QtWebKitWebPageThumbnailJob::handlePageLoadFinished(bool result)
 
 	if (m_size.isNull() || contentsSize.isNull())
 	{
+		releasePage();
+		deleteLater();
+
+		emit jobFinished(false);
+
 		return;
 	}
 
@@ -576,6 +619,7 @@ void QtWebKitWebPageThumbnailJob::handlePageLoadFinished(bool result)
 
 	if (contentsSize.isNull())
 	{
+		releasePage();
 		deleteLater();
 
 		emit jobFinished(true);
@@ -586,6 +630,11 @@ void QtWebKitWebPageThumbnailJob::handlePageLoadFinished(bool result)
 
 		QTimer::singleShot(1000, this, [=]()
 		{
+			if (!m_page)
+			{
+				return;
+			}
+
 			m_pixmap = QPixmap(contentsSize);
 			m_pixmap.fill(Qt::white);
 
@@ -595,6 +644,8 @@ void QtWebKitWebPageThumbnailJob::handlePageLoadFinished(bool result)
 
 			painter.end();
 
+			releasePage();
+
 			if (m_pixmap.size() != m_size)
 			{
 				m_pixmap = m_pixmap.scaled(m_size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
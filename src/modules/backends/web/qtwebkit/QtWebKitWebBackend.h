@@ -123,6 +123,9 @@ public slots:
 	void start() override;
 	void cancel() override;
 
+protected:
+	void releasePage();
+
 protected slots:
 	void handlePageLoadFinished(bool result);
 
@@ -132,6 +135,8 @@ private:
 	QUrl m_url;
 	QSize m_size;
 	QPixmap m_pixmap;
+
+	static QVector<QPointer<QtWebKitPage> > m_pages;
 };
 
 }
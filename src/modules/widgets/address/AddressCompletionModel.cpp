@@ -22,17 +22,25 @@
 #include "AddressCompletionModel.h"
 #include "../../../core/AddonsManager.h"
 #include "../../../core/BookmarksManager.h"
+#include "../../../core/Console.h"
 #include "../../../core/HistoryManager.h"
 #include "../../../core/SettingsManager.h"
 #include "../../../core/ThemesManager.h"
-#include "../../../core/Utils.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtMath>
 
 namespace Otter
 {
 
+QMap<AddressCompletionModel::LatencyStage, AddressCompletionModel::LatencyHistogram> AddressCompletionModel::m_latencyHistograms;
+
 AddressCompletionModel::AddressCompletionModel(QObject *parent) : QAbstractListModel(parent),
+	m_fileSystemWatcher(nullptr),
+	m_generation(0),
+	m_localPathsGeneration(0),
 	m_types(NoCompletionType),
 	m_updateTimer(0),
 	m_showCompletionCategories(true)
@@ -58,11 +66,20 @@ void AddressCompletionModel::timerEvent(QTimerEvent *event)
 
 void AddressCompletionModel::updateModel()
 {
-	QVector<CompletionEntry> completions;
-	completions.reserve(10);
+	++m_generation;
+
+	m_queryTimer.start();
+
+	const quint64 generation(m_generation);
+	const QString filter(m_filter);
+	const QPointer<AddressCompletionModel> model(this);
+	QMap<CompletionType, QVector<CompletionEntry> > sections;
+	QElapsedTimer timer;
 
 	if (m_types.testFlag(SearchSuggestionsCompletionType))
 	{
+		timer.start();
+
 		const QString keyword(m_filter.section(QLatin1Char(' '), 0, 0));
 		const SearchEnginesManager::SearchEngineDefinition searchEngine(SearchEnginesManager::getSearchEngine(keyword, true));
 		QString title(m_defaultSearchEngine.title);
@@ -85,6 +102,8 @@ void AddressCompletionModel::updateModel()
 			icon = ThemesManager::createIcon(QLatin1String("edit-find"));
 		}
 
+		QVector<CompletionEntry> completions;
+
 		if (m_showCompletionCategories)
 		{
 			completions.append(CompletionEntry({}, tr("Search with %1").arg(title), {}, {}, {}, CompletionEntry::HeaderType));
@@ -97,11 +116,19 @@ void AddressCompletionModel::updateModel()
 		completionEntry.keyword = keyword;
 
 		completions.append(completionEntry);
+
+		sections[SearchSuggestionsCompletionType] = completions;
+
+		addLatencySample(SearchSuggestionsStage, timer.nsecsElapsed());
 	}
 
 	if (m_types.testFlag(BookmarksCompletionType))
 	{
+		timer.start();
+
 		const QVector<BookmarksModel::BookmarkMatch> bookmarks(BookmarksManager::findBookmarks(m_filter));
+		QVector<CompletionEntry> completions;
+		completions.reserve(bookmarks.count() + 1);
 
 		if (m_showCompletionCategories && !bookmarks.isEmpty())
 		{
@@ -120,53 +147,74 @@ void AddressCompletionModel::updateModel()
 
 			completions.append(completionEntry);
 		}
+
+		sections[BookmarksCompletionType] = completions;
+
+		addLatencySample(BookmarksStage, timer.nsecsElapsed());
 	}
 
 	if (m_types.testFlag(LocalPathSuggestionsCompletionType) && (m_filter == QString(QLatin1Char('~')) || m_filter.contains(QDir::separator())))
 	{
-		const QString directory((m_filter == QString(QLatin1Char('~'))) ? QDir::homePath() : m_filter.section(QDir::separator(), 0, -2) + QDir::separator());
-		const QString prefix(m_filter.contains(QDir::separator()) ? m_filter.section(QDir::separator(), -1, -1) : QString());
-		const QStringList entries(QDir(Utils::normalizePath(directory)).entryList(QDir::AllEntries | QDir::NoDotAndDotDot));
-		bool headerWasAdded(!m_showCompletionCategories);
+		m_localPathsDirectory = ((m_filter == QString(QLatin1Char('~'))) ? QDir::homePath() : m_filter.section(QDir::separator(), 0, -2) + QDir::separator());
+		m_localPathsPrefix = (m_filter.contains(QDir::separator()) ? m_filter.section(QDir::separator(), -1, -1) : QString());
 
-		for (const QString &entry: entries)
+		const QString path(QDir::cleanPath(Utils::normalizePath(m_localPathsDirectory)));
+
+		if (m_directories.contains(path))
 		{
-			if (entry.startsWith(prefix, Qt::CaseInsensitive))
-			{
-				const QString path(directory + entry);
+			timer.start();
 
-				if (!headerWasAdded)
-				{
-					completions.append(CompletionEntry({}, tr("Local files"), {}, {}, {}, CompletionEntry::HeaderType));
+			m_directoriesOrder.removeAll(path);
+			m_directoriesOrder.append(path);
 
-					headerWasAdded = true;
-				}
+			sections[LocalPathSuggestionsCompletionType] = createLocalPathCompletions(m_directories[path]);
 
-				completions.append(CompletionEntry(QUrl::fromLocalFile(QDir::toNativeSeparators(path)), path, path, ThemesManager::getFileTypeIcon(path), {}, CompletionEntry::LocalPathType));
-			}
+			addLatencySample(LocalPathsStage, timer.nsecsElapsed());
+		}
+		else
+		{
+			m_localPathsGeneration = m_generation;
+
+			sections[LocalPathSuggestionsCompletionType] = getRetainedCompletions(LocalPathSuggestionsCompletionType);
+
+			listDirectory(path);
 		}
 	}
+	else
+	{
+		m_localPathsDirectory.clear();
+		m_localPathsPrefix.clear();
+	}
 
-	if (m_types.testFlag(HistoryCompletionType))
+	if (m_types.testFlag(HistoryCompletionType) && !m_filter.isEmpty())
 	{
-		const QVector<HistoryModel::HistoryEntryMatch> entries(HistoryManager::findEntries(m_filter));
+		const QSharedPointer<const QVector<HistoryModel::EntrySnapshot> > typedHistorySnapshot(HistoryManager::getTypedHistoryModel()->getSnapshot());
+		const QSharedPointer<const QVector<HistoryModel::EntrySnapshot> > browsingHistorySnapshot(HistoryManager::getBrowsingHistoryModel()->getSnapshot());
 
-		if (m_showCompletionCategories && !entries.isEmpty())
-		{
-			completions.append(CompletionEntry({}, tr("History"), {}, {}, {}, CompletionEntry::HeaderType));
-		}
+		sections[HistoryCompletionType] = getRetainedCompletions(HistoryCompletionType);
 
-		for (const HistoryModel::HistoryEntryMatch &match: entries)
+		QThreadPool::globalInstance()->start([=]()
 		{
-			HistoryModel::Entry *entry(match.entry);
+			QVector<HistoryModel::HistoryEntryMatch> entries(HistoryModel::findEntries(typedHistorySnapshot, filter, true));
+			entries.append(HistoryModel::findEntries(browsingHistorySnapshot, filter));
 
-			completions.append(CompletionEntry(entry->getUrl(), entry->getTitle(), match.match, entry->getIcon(), entry->getTimeVisited(), (match.isTypedIn ? CompletionEntry::TypedHistoryType : CompletionEntry::HistoryType)));
-		}
+			QMetaObject::invokeMethod(QCoreApplication::instance(), [=]()
+			{
+				if (model)
+				{
+					model->handleHistoryEntriesFound(generation, entries);
+				}
+			}, Qt::QueuedConnection);
+		});
 	}
 
 	if (m_types.testFlag(TypedHistoryCompletionType))
 	{
+		timer.start();
+
 		const QVector<HistoryModel::HistoryEntryMatch> entries(HistoryManager::findEntries({}, true));
+		QVector<CompletionEntry> completions;
+		completions.reserve(entries.count() + 1);
 
 		if (m_showCompletionCategories && !entries.isEmpty())
 		{
@@ -179,11 +227,18 @@ void AddressCompletionModel::updateModel()
 
 			completions.append(CompletionEntry(entry->getUrl(), entry->getTitle(), match.match, entry->getIcon(), entry->getTimeVisited(), CompletionEntry::TypedHistoryType, entry->getIdentifier()));
 		}
+
+		sections[TypedHistoryCompletionType] = completions;
+
+		addLatencySample(TypedHistoryStage, timer.nsecsElapsed());
 	}
 
 	if (m_types.testFlag(SpecialPagesCompletionType))
 	{
+		timer.start();
+
 		const QStringList specialPages(AddonsManager::getSpecialPages());
+		QVector<CompletionEntry> completions;
 		bool headerWasAdded(!m_showCompletionCategories);
 
 		for (int i = 0; i < specialPages.count(); ++i)
@@ -202,19 +257,180 @@ void AddressCompletionModel::updateModel()
 				completions.append(CompletionEntry(information.url, information.getTitle(), {}, information.icon, {}, CompletionEntry::SpecialPageType));
 			}
 		}
+
+		sections[SpecialPagesCompletionType] = completions;
+
+		addLatencySample(SpecialPagesStage, timer.nsecsElapsed());
 	}
 
-	completions.squeeze();
+	const QVector<CompletionType> types(getSectionTypes());
 
 	beginResetModel();
 
-	m_completions = completions;
+	m_completions.clear();
+	m_sections.clear();
+
+	for (const CompletionType type: types)
+	{
+		const QVector<CompletionEntry> completions(sections.value(type));
+
+		m_completions.append(completions);
+
+		m_sections[type] = completions.count();
+	}
+
+	m_completions.squeeze();
 
 	endResetModel();
+
+	addLatencySample(ModelStage, m_queryTimer.nsecsElapsed());
+}
+
+void AddressCompletionModel::handleHistoryEntriesFound(quint64 generation, const QVector<HistoryModel::HistoryEntryMatch> &entries)
+{
+	if (generation != m_generation)
+	{
+		return;
+	}
+
+	addLatencySample(HistoryStage, m_queryTimer.nsecsElapsed());
+
+	const HistoryModel *typedHistoryModel(HistoryManager::getTypedHistoryModel());
+	const HistoryModel *browsingHistoryModel(HistoryManager::getBrowsingHistoryModel());
+	QVector<CompletionEntry> completions;
+	completions.reserve(entries.count() + 1);
+
+	if (m_showCompletionCategories && !entries.isEmpty())
+	{
+		completions.append(CompletionEntry({}, tr("History"), {}, {}, {}, CompletionEntry::HeaderType));
+	}
+
+	for (const HistoryModel::HistoryEntryMatch &match: entries)
+	{
+		const HistoryModel::Entry *entry((match.isTypedIn ? typedHistoryModel : browsingHistoryModel)->getEntry(match.identifier));
+
+		if (entry)
+		{
+			completions.append(CompletionEntry(entry->getUrl(), entry->getTitle(), match.match, entry->getIcon(), entry->getTimeVisited(), (match.isTypedIn ? CompletionEntry::TypedHistoryType : CompletionEntry::HistoryType)));
+		}
+	}
+
+	if (completions.count() == 1 && m_showCompletionCategories)
+	{
+		completions.clear();
+	}
+
+	setCompletions(HistoryCompletionType, completions);
+}
+
+void AddressCompletionModel::listDirectory(const QString &path)
+{
+	if (m_pendingDirectories.contains(path))
+	{
+		return;
+	}
+
+	m_pendingDirectories.insert(path);
+
+	const QPointer<AddressCompletionModel> model(this);
+
+	QThreadPool::globalInstance()->start([=]()
+	{
+		const QStringList entries(QDir(path).entryList(QDir::AllEntries | QDir::NoDotAndDotDot));
+
+		QMetaObject::invokeMethod(QCoreApplication::instance(), [=]()
+		{
+			if (model)
+			{
+				model->handleDirectoryListed(path, entries);
+			}
+		}, Qt::QueuedConnection);
+	});
+}
+
+void AddressCompletionModel::handleDirectoryListed(const QString &path, const QStringList &entries)
+{
+	m_pendingDirectories.remove(path);
+	m_fileTypeIcons.clear();
+
+	if (!m_fileSystemWatcher)
+	{
+		m_fileSystemWatcher = new QFileSystemWatcher(this);
+
+		connect(m_fileSystemWatcher, &QFileSystemWatcher::directoryChanged, this, &AddressCompletionModel::listDirectory);
+	}
+
+	if (m_fileSystemWatcher->directories().contains(path) || m_fileSystemWatcher->addPath(path))
+	{
+		m_directories[path] = entries;
+
+		m_directoriesOrder.removeAll(path);
+		m_directoriesOrder.append(path);
+
+		while (m_directoriesOrder.count() > 10)
+		{
+			const QString removedPath(m_directoriesOrder.takeFirst());
+
+			m_directories.remove(removedPath);
+			m_fileSystemWatcher->removePath(removedPath);
+		}
+	}
+	else
+	{
+		m_directories.remove(path);
+		m_directoriesOrder.removeAll(path);
+	}
+
+	if (!m_localPathsDirectory.isEmpty() && QDir::cleanPath(Utils::normalizePath(m_localPathsDirectory)) == path)
+	{
+		if (m_localPathsGeneration == m_generation)
+		{
+			m_localPathsGeneration = 0;
+
+			addLatencySample(LocalPathsStage, m_queryTimer.nsecsElapsed());
+		}
+
+		setCompletions(LocalPathSuggestionsCompletionType, createLocalPathCompletions(entries));
+	}
+}
+
+void AddressCompletionModel::setCompletions(CompletionType type, const QVector<CompletionEntry> &completions)
+{
+	const int offset(getSectionOffset(type));
+	const int amount(m_sections.value(type, 0));
+
+	if (amount == 0 && completions.isEmpty())
+	{
+		return;
+	}
+
+	if (amount > 0)
+	{
+		beginRemoveRows({}, offset, (offset + amount - 1));
+
+		m_completions.remove(offset, amount);
+
+		endRemoveRows();
+	}
+
+	if (!completions.isEmpty())
+	{
+		beginInsertRows({}, offset, (offset + completions.count() - 1));
+
+		m_completions = (m_completions.mid(0, offset) + completions + m_completions.mid(offset));
+
+		endInsertRows();
+	}
+
+	m_sections[type] = completions.count();
+
+	emit completionUpdated(m_filter);
 }
 
 void AddressCompletionModel::setFilter(const QString &filter)
 {
+	m_inputTimer.start();
+
 	m_filter = filter;
 	m_showCompletionCategories = SettingsManager::getOption(SettingsManager::AddressField_ShowCompletionCategoriesOption).toBool();
 
@@ -229,7 +445,10 @@ void AddressCompletionModel::setFilter(const QString &filter)
 
 		beginResetModel();
 
+		++m_generation;
+
 		m_completions.clear();
+		m_sections.clear();
 
 		endResetModel();
 
@@ -263,6 +482,78 @@ void AddressCompletionModel::setTypes(CompletionTypes types, bool force)
 	updateModel();
 }
 
+void AddressCompletionModel::addLatencySample(LatencyStage stage, qint64 time)
+{
+	LatencyHistogram &histogram(m_latencyHistograms[stage]);
+
+	if (histogram.buckets.isEmpty())
+	{
+		histogram.buckets.fill(0, 12);
+	}
+
+	int bucket(0);
+
+	while (bucket < (histogram.buckets.count() - 1) && time > (1000000LL << bucket))
+	{
+		++bucket;
+	}
+
+	++histogram.buckets[bucket];
+	++histogram.count;
+
+	histogram.total += time;
+	histogram.maximum = qMax(histogram.maximum, time);
+
+	if (SettingsManager::getOption(SettingsManager::AddressField_LogCompletionLatencyOption).toBool())
+	{
+		Console::addMessage(QStringLiteral("Address completion stage %1 took %2 ms").arg(getLatencyStageName(stage), QString::number((time / 1000000.0), 'f', 2)), Console::OtherCategory, Console::DebugLevel);
+	}
+}
+
+DiagnosticReport::Section AddressCompletionModel::createReport()
+{
+	DiagnosticReport::Section report;
+	report.title = QLatin1String("Address Completion Latency");
+	report.fieldWidths = {20, 15, 20, 20, 20, 0};
+
+	QMap<LatencyStage, LatencyHistogram>::const_iterator iterator;
+
+	for (iterator = m_latencyHistograms.constBegin(); iterator != m_latencyHistograms.constEnd(); ++iterator)
+	{
+		const LatencyHistogram histogram(iterator.value());
+		const int percentileCount(qCeil(histogram.count * 0.95));
+		QStringList buckets;
+		QString percentile;
+		int count(0);
+
+		for (int i = 0; i < histogram.buckets.count(); ++i)
+		{
+			const QString limit((i < (histogram.buckets.count() - 1)) ? QStringLiteral("<=%1").arg(1 << i) : QStringLiteral(">%1").arg(1 << (i - 1)));
+
+			count += histogram.buckets.at(i);
+
+			if (percentile.isEmpty() && count >= percentileCount)
+			{
+				percentile = QStringLiteral("p95 %1 ms").arg(limit);
+			}
+
+			if (histogram.buckets.at(i) > 0)
+			{
+				buckets.append(QStringLiteral("%1:%2").arg(limit).arg(histogram.buckets.at(i)));
+			}
+		}
+
+		report.entries.append({getLatencyStageName(iterator.key()), QStringLiteral("%1 samples").arg(histogram.count), QStringLiteral("avg %1 ms").arg(QString::number((histogram.total / (histogram.count * 1000000.0)), 'f', 2)), percentile, QStringLiteral("max %1 ms").arg(QString::number((histogram.maximum / 1000000.0), 'f', 2)), buckets.join(QLatin1Char(' '))});
+	}
+
+	if (report.entries.isEmpty())
+	{
+		report.entries.append({QLatin1String("No samples")});
+	}
+
+	return report;
+}
+
 QVariant AddressCompletionModel::data(const QModelIndex &index, int role) const
 {
 	if (index.column() != 0 || !(index.row() >= 0 && index.row() < m_completions.count()))
@@ -275,6 +566,16 @@ QVariant AddressCompletionModel::data(const QModelIndex &index, int role) const
 	switch (role)
 	{
 		case Qt::DecorationRole:
+			if (entry.type == CompletionEntry::LocalPathType && entry.icon.isNull())
+			{
+				if (!m_fileTypeIcons.contains(entry.title))
+				{
+					m_fileTypeIcons[entry.title] = ThemesManager::getFileTypeIcon(Utils::normalizePath(entry.title));
+				}
+
+				return m_fileTypeIcons[entry.title];
+			}
+
 			return entry.icon;
 		case HistoryIdentifierRole:
 			return entry.historyIdentifier;
@@ -320,6 +621,118 @@ Qt::ItemFlags AddressCompletionModel::flags(const QModelIndex &index) const
 	return (Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemNeverHasChildren);
 }
 
+QVector<AddressCompletionModel::CompletionEntry> AddressCompletionModel::getRetainedCompletions(CompletionType type) const
+{
+	const QVector<CompletionEntry> completions(m_completions.mid(getSectionOffset(type), m_sections.value(type, 0)));
+	QVector<CompletionEntry> retainedCompletions;
+
+	for (const CompletionEntry &completion: completions)
+	{
+		if (completion.type != CompletionEntry::HeaderType && completion.match.startsWith(m_filter, Qt::CaseInsensitive))
+		{
+			retainedCompletions.append(completion);
+		}
+	}
+
+	if (!retainedCompletions.isEmpty() && m_showCompletionCategories && completions.at(0).type == CompletionEntry::HeaderType)
+	{
+		retainedCompletions.prepend(completions.at(0));
+	}
+
+	return retainedCompletions;
+}
+
+QVector<AddressCompletionModel::CompletionEntry> AddressCompletionModel::createLocalPathCompletions(const QStringList &entries) const
+{
+	QVector<CompletionEntry> completions;
+	bool headerWasAdded(!m_showCompletionCategories);
+
+	for (const QString &entry: entries)
+	{
+		if (entry.startsWith(m_localPathsPrefix, Qt::CaseInsensitive))
+		{
+			const QString path(m_localPathsDirectory + entry);
+
+			if (!headerWasAdded)
+			{
+				completions.append(CompletionEntry({}, tr("Local files"), {}, {}, {}, CompletionEntry::HeaderType));
+
+				headerWasAdded = true;
+			}
+
+			completions.append(CompletionEntry(QUrl::fromLocalFile(QDir::toNativeSeparators(path)), path, path, {}, {}, CompletionEntry::LocalPathType));
+		}
+	}
+
+	return completions;
+}
+
+QString AddressCompletionModel::getLatencyStageName(LatencyStage stage)
+{
+	switch (stage)
+	{
+		case SearchSuggestionsStage:
+			return QLatin1String("Search");
+		case BookmarksStage:
+			return QLatin1String("Bookmarks");
+		case LocalPathsStage:
+			return QLatin1String("Local Files");
+		case HistoryStage:
+			return QLatin1String("History");
+		case TypedHistoryStage:
+			return QLatin1String("Typed History");
+		case SpecialPagesStage:
+			return QLatin1String("Special Pages");
+		case ModelStage:
+			return QLatin1String("Model Update");
+		case PopupStage:
+			return QLatin1String("Popup");
+		case InputStage:
+			return QLatin1String("Input to Popup");
+		default:
+			break;
+	}
+
+	return {};
+}
+
+QVector<AddressCompletionModel::CompletionType> AddressCompletionModel::getSectionTypes()
+{
+	return {SearchSuggestionsCompletionType, BookmarksCompletionType, LocalPathSuggestionsCompletionType, HistoryCompletionType, TypedHistoryCompletionType, SpecialPagesCompletionType};
+}
+
+int AddressCompletionModel::getSectionOffset(CompletionType type) const
+{
+	const QVector<CompletionType> types(getSectionTypes());
+	int offset(0);
+
+	for (const CompletionType sectionType: types)
+	{
+		if (sectionType == type)
+		{
+			break;
+		}
+
+		offset += m_sections.value(sectionType, 0);
+	}
+
+	return offset;
+}
+
+qint64 AddressCompletionModel::takeInputLatency()
+{
+	if (!m_inputTimer.isValid())
+	{
+		return -1;
+	}
+
+	const qint64 latency(m_inputTimer.nsecsElapsed());
+
+	m_inputTimer.invalidate();
+
+	return latency;
+}
+
 int AddressCompletionModel::rowCount(const QModelIndex &index) const
 {
 	return (index.isValid() ? 0 : m_completions.count());
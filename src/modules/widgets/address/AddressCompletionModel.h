@@ -22,9 +22,14 @@
 #ifndef OTTER_ADDRESSCOMPLETIONMODEL_H
 #define OTTER_ADDRESSCOMPLETIONMODEL_H
 
+#include "../../../core/HistoryModel.h"
 #include "../../../core/SearchEnginesManager.h"
+#include "../../../core/Utils.h"
 
 #include <QtCore/QAbstractListModel>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QSet>
 #include <QtCore/QUrl>
 
 namespace Otter
@@ -48,6 +53,19 @@ public:
 
 	Q_DECLARE_FLAGS(CompletionTypes, CompletionType)
 
+	enum LatencyStage
+	{
+		SearchSuggestionsStage = 0,
+		BookmarksStage,
+		LocalPathsStage,
+		HistoryStage,
+		TypedHistoryStage,
+		SpecialPagesStage,
+		ModelStage,
+		PopupStage,
+		InputStage
+	};
+
 	enum EntryRole
 	{
 		TextRole = Qt::DisplayRole,
@@ -92,12 +110,23 @@ public:
 		CompletionEntry() = default;
 	};
 
+	struct LatencyHistogram final
+	{
+		QVector<int> buckets;
+		qint64 total = 0;
+		qint64 maximum = 0;
+		int count = 0;
+	};
+
 	explicit AddressCompletionModel(QObject *parent = nullptr);
 
 	void setTypes(CompletionTypes types, bool force = false);
+	static void addLatencySample(LatencyStage stage, qint64 time);
+	static DiagnosticReport::Section createReport();
 	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 	Qt::ItemFlags flags(const QModelIndex &index) const override;
+	qint64 takeInputLatency();
 	int rowCount(const QModelIndex &index = {}) const override;
 	bool event(QEvent *event) override;
 
@@ -107,17 +136,41 @@ public slots:
 protected:
 	void timerEvent(QTimerEvent *event) override;
 	void updateModel();
+	void handleHistoryEntriesFound(quint64 generation, const QVector<HistoryModel::HistoryEntryMatch> &entries);
+	void listDirectory(const QString &path);
+	void handleDirectoryListed(const QString &path, const QStringList &entries);
+	void setCompletions(CompletionType type, const QVector<CompletionEntry> &completions);
+	QVector<CompletionEntry> createLocalPathCompletions(const QStringList &entries) const;
+	QVector<CompletionEntry> getRetainedCompletions(CompletionType type) const;
+	static QString getLatencyStageName(LatencyStage stage);
+	static QVector<CompletionType> getSectionTypes();
+	int getSectionOffset(CompletionType type) const;
 
 private:
+	QFileSystemWatcher *m_fileSystemWatcher;
 	QVector<CompletionEntry> m_completions;
+	QMap<CompletionType, int> m_sections;
+	QHash<QString, QStringList> m_directories;
+	QStringList m_directoriesOrder;
+	QSet<QString> m_pendingDirectories;
+	mutable QHash<QString, QIcon> m_fileTypeIcons;
 	QString m_filter;
+	QString m_localPathsDirectory;
+	QString m_localPathsPrefix;
+	QElapsedTimer m_inputTimer;
+	QElapsedTimer m_queryTimer;
 	SearchEnginesManager::SearchEngineDefinition m_defaultSearchEngine;
+	quint64 m_generation;
+	quint64 m_localPathsGeneration;
 	AddressCompletionModel::CompletionTypes m_types;
 	int m_updateTimer;
 	bool m_showCompletionCategories;
 
+	static QMap<LatencyStage, LatencyHistogram> m_latencyHistograms;
+
 signals:
 	void completionReady(const QString &filter);
+	void completionUpdated(const QString &filter);
 };
 
 }
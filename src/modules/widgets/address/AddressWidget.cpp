@@ -326,19 +326,49 @@ AddressWidget::AddressWidget(Window *window, QWidget *parent) : LineEditWidget(p
 			updateCompletion(true, true);
 		}
 	});
-	connect(this, &AddressWidget::textEdited, this, [&]()
+	connect(this, &AddressWidget::textEdited, this, [&](const QString &text)
 	{
 		m_wasEdited = true;
+
+		if (m_completionModes.testFlag(InlineCompletionMode))
+		{
+			const QString completion(HistoryManager::findInlineCompletion(text));
+
+			if (!completion.isEmpty())
+			{
+				LineEditWidget::setCompletion(completion);
+			}
+		}
 	});
 	connect(this, &AddressWidget::textDropped, this, [&](const QString &text)
 	{
 		handleUserInput(text);
 	});
 	connect(m_completionModel, &AddressCompletionModel::completionReady, this, &AddressWidget::setCompletion);
+	connect(m_completionModel, &AddressCompletionModel::completionUpdated, this, [&](const QString &filter)
+	{
+		if (!hasFocus())
+		{
+			return;
+		}
+
+		if (!isPopupVisible() || m_completionModel->rowCount() == 0)
+		{
+			setCompletion(filter);
+		}
+		else if (m_completionModes.testFlag(InlineCompletionMode))
+		{
+			updateInlineCompletion(filter);
+		}
+	});
 	connect(BookmarksManager::getModel(), &BookmarksModel::modelModified, this, [&]()
 	{
 		updateEntries({BookmarkEntry});
 	});
+	connect(BookmarksManager::getModel(), &BookmarksModel::loadingFinished, this, [&]()
+	{
+		updateEntries({BookmarkEntry});
+	});
 }
 
 void AddressWidget::changeEvent(QEvent *event)
@@ -1338,28 +1368,54 @@ void AddressWidget::setCompletion(const QString &filter)
 	{
 		hidePopup();
 
-		LineEditWidget::setCompletion({});
+		LineEditWidget::setCompletion(m_completionModes.testFlag(InlineCompletionMode) ? HistoryManager::findInlineCompletion(filter) : QString());
 
 		return;
 	}
 
 	if (m_completionModes.testFlag(PopupCompletionMode))
 	{
+		QElapsedTimer timer;
+		timer.start();
+
 		showCompletion(false);
+
+		AddressCompletionModel::addLatencySample(AddressCompletionModel::PopupStage, timer.nsecsElapsed());
 	}
 
 	if (m_completionModes.testFlag(InlineCompletionMode))
 	{
-		for (int i = 0; i < m_completionModel->rowCount(); ++i)
-		{
-			const QString matchedText(m_completionModel->index(i).data(AddressCompletionModel::MatchRole).toString());
+		updateInlineCompletion(filter);
+	}
 
-			if (!matchedText.isEmpty())
-			{
-				LineEditWidget::setCompletion(matchedText);
+	const qint64 inputLatency(m_completionModel->takeInputLatency());
 
-				break;
-			}
+	if (inputLatency >= 0)
+	{
+		AddressCompletionModel::addLatencySample(AddressCompletionModel::InputStage, inputLatency);
+	}
+}
+
+void AddressWidget::updateInlineCompletion(const QString &filter)
+{
+	const QString completion(HistoryManager::findInlineCompletion(filter));
+
+	if (!completion.isEmpty())
+	{
+		LineEditWidget::setCompletion(completion);
+
+		return;
+	}
+
+	for (int i = 0; i < m_completionModel->rowCount(); ++i)
+	{
+		const QString matchedText(m_completionModel->index(i).data(AddressCompletionModel::MatchRole).toString());
+
+		if (!matchedText.isEmpty())
+		{
+			LineEditWidget::setCompletion(matchedText);
+
+			break;
 		}
 	}
 }
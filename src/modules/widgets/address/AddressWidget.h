@@ -158,6 +158,7 @@ protected slots:
 	void updateCurrentEntries();
 	void updateGeometries();
 	void updateCompletion(bool isTypedHistory, bool force = false);
+	void updateInlineCompletion(const QString &filter);
 	void setCompletion(const QString &filter);
 
 private:
@@ -18,7 +18,6 @@
 **************************************************************************/
 
 #include "CacheContentsWidget.h"
-#include "../../../core/HistoryManager.h"
 #include "../../../core/NetworkCache.h"
 #include "../../../core/NetworkManagerFactory.h"
 #include "../../../core/ThemesManager.h"
@@ -29,7 +28,6 @@
 #include "ui_CacheContentsWidget.h"
 
 #include <QtCore/QMimeDatabase>
-#include <QtCore/QTimer>
 #include <QtGui/QClipboard>
 #include <QtGui/QMouseEvent>
 #include <QtWidgets/QMenu>
@@ -38,13 +36,15 @@ namespace Otter
 {
 
 CacheContentsWidget::CacheContentsWidget(const QVariantMap &parameters, Window *window, QWidget *parent) : SpecialPageContentsWidget(QLatin1String("cache"), parameters, window, parent),
-	m_model(new QStandardItemModel(this)),
-	m_isLoading(true),
+	m_model(new CacheModel(NetworkManagerFactory::getCache(), this)),
 	m_ui(new Ui::CacheContentsWidget)
 {
 	m_ui->setupUi(this);
 	m_ui->filterLineEditWidget->setClearOnEscape(true);
 	m_ui->cacheViewWidget->setViewMode(ItemViewWidget::TreeView);
+	m_ui->cacheViewWidget->setModel(m_model);
+	m_ui->cacheViewWidget->setLayoutDirection(Qt::LeftToRight);
+	m_ui->cacheViewWidget->setFilterRoles({Qt::DisplayRole, CacheModel::UrlRole});
 	m_ui->cacheViewWidget->installEventFilter(this);
 	m_ui->cacheViewWidget->viewport()->installEventFilter(this);
 	m_ui->previewLabel->hide();
@@ -54,8 +54,12 @@ CacheContentsWidget::CacheContentsWidget(const QVariantMap &parameters, Window *
 		m_ui->detailsWidget->hide();
 	}
 
-	QTimer::singleShot(100, this, &CacheContentsWidget::populateCache);
-
+	connect(m_model, &CacheModel::loadingFinished, this, [&]()
+	{
+		emit loadingStateChanged(WebWidget::FinishedLoadingState);
+	});
+	connect(m_model, &CacheModel::modelReset, this, &CacheContentsWidget::updateActions);
+	connect(m_ui->cacheViewWidget, &ItemViewWidget::needsActionsUpdate, this, &CacheContentsWidget::updateActions);
 	connect(m_ui->filterLineEditWidget, &LineEditWidget::textChanged, m_ui->cacheViewWidget, &ItemViewWidget::setFilterString);
 	connect(m_ui->cacheViewWidget, &ItemViewWidget::doubleClicked, this, &CacheContentsWidget::openEntry);
 	connect(m_ui->cacheViewWidget, &ItemViewWidget::customContextMenuRequested, this, &CacheContentsWidget::showContextMenu);
@@ -75,7 +79,7 @@ void CacheContentsWidget::changeEvent(QEvent *event)
 	{
 		m_ui->retranslateUi(this);
 
-		m_model->setHorizontalHeaderLabels({tr("Address"), tr("Type"), tr("Size"), tr("Last Modified"), tr("Expires")});
+		emit m_model->headerDataChanged(Qt::Horizontal, 0, (m_model->columnCount() - 1));
 	}
 }
 
@@ -108,65 +112,20 @@ void CacheContentsWidget::triggerAction(int identifier, const QVariantMap &param
 	}
 }
 
-void CacheContentsWidget::populateCache()
-{
-	m_model->clear();
-	m_model->setHorizontalHeaderLabels({tr("Address"), tr("Type"), tr("Size"), tr("Last Modified"), tr("Expires")});
-	m_model->setHeaderData(0, Qt::Horizontal, 500, HeaderViewWidget::WidthRole);
-	m_model->setHeaderData(2, Qt::Horizontal, 150, HeaderViewWidget::WidthRole);
-	m_model->setSortRole(Qt::DisplayRole);
-
-	const NetworkCache *cache(NetworkManagerFactory::getCache());
-	const QVector<QUrl> entries(cache->getEntries());
-
-	for (const QUrl &entry: entries)
-	{
-		handleEntryAdded(entry);
-	}
-
-	m_model->sort(0);
-
-	if (!m_isLoading)
-	{
-		return;
-	}
-
-	m_ui->cacheViewWidget->setModel(m_model);
-	m_ui->cacheViewWidget->setLayoutDirection(Qt::LeftToRight);
-	m_ui->cacheViewWidget->setFilterRoles({Qt::DisplayRole, Qt::UserRole});
-
-	m_isLoading = false;
-
-	emit loadingStateChanged(WebWidget::FinishedLoadingState);
-
-	connect(cache, &NetworkCache::cleared, this, &CacheContentsWidget::populateCache);
-	connect(cache, &NetworkCache::entryAdded, this, &CacheContentsWidget::handleEntryAdded);
-	connect(cache, &NetworkCache::entryRemoved, this, &CacheContentsWidget::handleEntryRemoved);
-	connect(m_model, &QStandardItemModel::modelReset, this, &CacheContentsWidget::updateActions);
-	connect(m_ui->cacheViewWidget, &ItemViewWidget::needsActionsUpdate, this, &CacheContentsWidget::updateActions);
-}
-
 void CacheContentsWidget::removeDomainEntries()
 {
-	const QModelIndex index(m_ui->cacheViewWidget->currentIndex());
-	const QStandardItem *domainItem(findDomainItem((index.isValid() && index.parent() == m_model->invisibleRootItem()->index()) ? index.sibling(index.row(), 0).data(Qt::ToolTipRole).toString() : Utils::extractHost(getEntry(index))));
-
-	if (!domainItem)
-	{
-		return;
-	}
-
+	const QVector<QUrl> entries(m_model->getUrls(m_model->getHost(m_ui->cacheViewWidget->currentIndex())));
 	NetworkCache *cache(NetworkManagerFactory::getCache());
 
-	for (int i = (domainItem->rowCount() - 1); i >= 0; --i)
+	for (int i = (entries.count() - 1); i >= 0; --i)
 	{
-		cache->remove(ItemModel::getItemData(domainItem->child(i, 0), UrlRole).toUrl());
+		cache->remove(entries.at(i));
 	}
 }
 
 void CacheContentsWidget::removeDomainEntriesOrEntry()
 {
-	const QUrl url(getEntry(m_ui->cacheViewWidget->currentIndex()));
+	const QUrl url(m_model->getUrl(m_ui->cacheViewWidget->currentIndex()));
 
 	if (url.isValid())
 	{
@@ -180,14 +139,7 @@ void CacheContentsWidget::removeDomainEntriesOrEntry()
 
 void CacheContentsWidget::openEntry()
 {
-	const QModelIndex index(m_ui->cacheViewWidget->currentIndex());
-
-	if (!index.isValid() || index.parent() == m_model->invisibleRootItem()->index())
-	{
-		return;
-	}
-
-	const QUrl url(getEntry(index));
+	const QUrl url(m_model->getUrl(m_ui->cacheViewWidget->currentIndex()));
 
 	if (!url.isValid())
 	{
@@ -210,131 +162,11 @@ void CacheContentsWidget::openEntry()
 	}
 }
 
-void CacheContentsWidget::handleEntryAdded(const QUrl &url)
-{
-	const QString domain(url.host());
-	QStandardItem *domainItem(findDomainItem(domain));
-
-	if (domainItem)
-	{
-		for (int i = 0; i < domainItem->rowCount(); ++i)
-		{
-			if (ItemModel::getItemData(domainItem->child(i, 0), UrlRole).toUrl() == url)
-			{
-				return;
-			}
-		}
-	}
-	else
-	{
-		domainItem = new QStandardItem(HistoryManager::getIcon(QUrl(QStringLiteral("http://%1/").arg(domain))), domain);
-		domainItem->setToolTip(domain);
-
-		m_model->appendRow(domainItem);
-		m_model->setItem(domainItem->row(), 2, new QStandardItem());
-
-		if (!m_isLoading)
-		{
-			m_model->sort(0);
-		}
-	}
-
-	NetworkCache *cache(NetworkManagerFactory::getCache());
-	QIODevice *device(cache->data(url));
-	const QNetworkCacheMetaData metaData(cache->metaData(url));
-	const QList<QPair<QByteArray, QByteArray> > headers(metaData.rawHeaders());
-	QString type;
-
-	for (const QPair<QByteArray, QByteArray> &header: headers)
-	{
-		if (header.first == QByteArrayLiteral("Content-Type"))
-		{
-			type = QString::fromLatin1(header.second);
-
-			break;
-		}
-	}
-
-	const QMimeType mimeType((device && type.isEmpty()) ? QMimeDatabase().mimeTypeForData(device) : QMimeDatabase().mimeTypeForName(type));
-	QList<QStandardItem*> entryItems({new QStandardItem(url.path()), new QStandardItem(mimeType.name()), new QStandardItem(device ? Utils::formatUnit(device->size()) : QString()), new QStandardItem(Utils::formatDateTime(metaData.lastModified())), new QStandardItem(Utils::formatDateTime(metaData.expirationDate()))});
-	entryItems[0]->setData(url, UrlRole);
-	entryItems[0]->setFlags(entryItems[0]->flags() | Qt::ItemNeverHasChildren);
-	entryItems[1]->setFlags(entryItems[1]->flags() | Qt::ItemNeverHasChildren);
-	entryItems[2]->setData((device ? device->size() : 0), SizeRole);
-	entryItems[2]->setFlags(entryItems[2]->flags() | Qt::ItemNeverHasChildren);
-	entryItems[3]->setFlags(entryItems[3]->flags() | Qt::ItemNeverHasChildren);
-	entryItems[4]->setFlags(entryItems[4]->flags() | Qt::ItemNeverHasChildren);
-
-	if (device)
-	{
-		QStandardItem *sizeItem(m_model->item(domainItem->row(), 2));
-
-		if (sizeItem)
-		{
-			sizeItem->setData((sizeItem->data(SizeRole).toLongLong() + device->size()), SizeRole);
-			sizeItem->setText(Utils::formatUnit(sizeItem->data(SizeRole).toLongLong()));
-		}
-
-		device->deleteLater();
-	}
-
-	domainItem->appendRow(entryItems);
-	domainItem->setText(QStringLiteral("%1 (%2)").arg(domain, QString::number(domainItem->rowCount())));
-
-	if (!m_isLoading)
-	{
-		domainItem->sortChildren(0, Qt::DescendingOrder);
-	}
-}
-
-void CacheContentsWidget::handleEntryRemoved(const QUrl &url)
-{
-	QStandardItem *domainItem(findDomainItem(Utils::extractHost(url)));
-
-	if (!domainItem)
-	{
-		return;
-	}
-
-	for (int i = 0; i < domainItem->rowCount(); ++i)
-	{
-		QStandardItem *entryItem(domainItem->child(i, 0));
-
-		if (!entryItem || entryItem->data(UrlRole).toUrl() != url)
-		{
-			continue;
-		}
-
-		const qint64 size(ItemModel::getItemData(domainItem->child(entryItem->row(), 2), SizeRole).toLongLong());
-
-		m_model->removeRow(entryItem->row(), domainItem->index());
-
-		if (domainItem->rowCount() == 0)
-		{
-			m_model->invisibleRootItem()->removeRow(domainItem->row());
-		}
-		else
-		{
-			QStandardItem *domainSizeItem(m_model->item(domainItem->row(), 2));
-
-			if (domainSizeItem && size > 0)
-			{
-				domainSizeItem->setData((domainSizeItem->data(SizeRole).toLongLong() - size), SizeRole);
-				domainSizeItem->setText(Utils::formatUnit(domainSizeItem->data(SizeRole).toLongLong()));
-			}
-
-			domainItem->setText(QStringLiteral("%1 (%2)").arg(url.host(), QString::number(domainItem->rowCount())));
-		}
-
-		break;
-	}
-}
-
 void CacheContentsWidget::showContextMenu(const QPoint &position)
 {
 	MainWindow *mainWindow(MainWindow::findMainWindow(this));
 	const QModelIndex index(m_ui->cacheViewWidget->indexAt(position));
-	const QUrl url(getEntry(index));
+	const QUrl url(m_model->getUrl(index));
 	QMenu menu(this);
 
 	if (url.isValid())
@@ -348,7 +180,7 @@ void CacheContentsWidget::showContextMenu(const QPoint &position)
 		menu.addSeparator();
 		menu.addAction(tr("Copy Link to Clipboard"), this, [&]()
 		{
-			const QUrl url(getEntry(m_ui->cacheViewWidget->currentIndex()));
+			const QUrl url(m_model->getUrl(m_ui->cacheViewWidget->currentIndex()));
 
 			if (url.isValid())
 			{
@@ -358,7 +190,7 @@ void CacheContentsWidget::showContextMenu(const QPoint &position)
 		menu.addSeparator();
 		menu.addAction(tr("Remove Entry"), this, [&]()
 		{
-			const QUrl url(getEntry(m_ui->cacheViewWidget->currentIndex()));
+			const QUrl url(m_model->getUrl(m_ui->cacheViewWidget->currentIndex()));
 
 			if (url.isValid())
 			{
@@ -367,7 +199,7 @@ void CacheContentsWidget::showContextMenu(const QPoint &position)
 		});
 	}
 
-	if (url.isValid() || (index.isValid() && index.parent() == m_model->invisibleRootItem()->index()))
+	if (url.isValid() || m_model->isHost(index))
 	{
 		menu.addAction(tr("Remove All Entries from This Domain"), this, &CacheContentsWidget::removeDomainEntries);
 		menu.addSeparator();
@@ -380,8 +212,8 @@ void CacheContentsWidget::showContextMenu(const QPoint &position)
 void CacheContentsWidget::updateActions()
 {
 	const QModelIndex index(m_ui->cacheViewWidget->getCurrentIndex());
-	const QUrl url(getEntry(index));
-	const QString domain((index.isValid() && index.parent() == m_model->invisibleRootItem()->index()) ? index.sibling(index.row(), 0).data(Qt::ToolTipRole).toString() : url.host());
+	const QUrl url(m_model->getUrl(index));
+	const QString domain(m_model->getHost(index));
 
 	m_ui->locationLabelWidget->setText({});
 	m_ui->locationLabelWidget->setUrl({});
@@ -389,6 +221,11 @@ void CacheContentsWidget::updateActions()
 	m_ui->previewLabel->setPixmap({});
 	m_ui->deleteButton->setEnabled(!domain.isEmpty());
 
+	const NetworkCache::MemoryCacheStatistics statistics(NetworkManagerFactory::getCache()->getMemoryCacheStatistics());
+	const qint64 requests(statistics.hits + statistics.misses);
+
+	m_ui->memoryCacheLabelWidget->setText(tr("%1 in %n entries, %2% hits", "", statistics.amount).arg(Utils::formatUnit(statistics.size), QString::number((requests > 0) ? qRound((statistics.hits * 100.0) / requests) : 0)));
+
 	if (!url.isValid())
 	{
 		m_ui->addressLabelWidget->setText({});
@@ -408,8 +245,8 @@ void CacheContentsWidget::updateActions()
 	}
 
 	NetworkCache *cache(NetworkManagerFactory::getCache());
-	QIODevice *device(cache->data(url));
-	const QNetworkCacheMetaData metaData(cache->metaData(url));
+	QIODevice *device(cache->peekData(url));
+	const QNetworkCacheMetaData metaData(cache->peekMetaData(url));
 	const QMimeDatabase mimeDatabase;
 	QMimeType mimeType;
 
@@ -466,86 +303,34 @@ void CacheContentsWidget::updateActions()
 	m_ui->locationLabelWidget->setText(localUrl.toString(QUrl::FullyDecoded | QUrl::PreferLocalFile));
 	m_ui->locationLabelWidget->setUrl(localUrl);
 	m_ui->typeLabelWidget->setText(mimeType.name());
-	m_ui->sizeLabelWidget->setText(device ? Utils::formatUnit(device->size(), false, 2) : tr("Unknown"));
-	m_ui->lastModifiedLabelWidget->setText(Utils::formatDateTime(metaData.lastModified()));
-	m_ui->expiresLabelWidget->setText(Utils::formatDateTime(metaData.expirationDate()));
-
-	if (!preview.isNull())
-	{
-		m_ui->previewLabel->show();
-		m_ui->previewLabel->setPixmap(preview);
-	}
+	const NetworkCache::EntryInformation entry(cache->getEntry(url));
 
-	QStandardItem *typeItem(m_model->itemFromIndex(index.sibling(index.row(), 1)));
-
-	if (typeItem && typeItem->text().isEmpty())
+	if (device && entry.size > 0 && entry.size < device->size())
 	{
-		typeItem->setText(mimeType.name());
+		m_ui->sizeLabelWidget->setText(tr("%1 (%2 on disk)").arg(Utils::formatUnit(device->size(), false, 2), Utils::formatUnit(entry.size, false, 2)));
 	}
-
-	QStandardItem *lastModifiedItem(m_model->itemFromIndex(index.sibling(index.row(), 3)));
-
-	if (lastModifiedItem && lastModifiedItem->text().isEmpty())
+	else
 	{
-		lastModifiedItem->setText(metaData.lastModified().toString());
+		m_ui->sizeLabelWidget->setText(device ? Utils::formatUnit(device->size(), false, 2) : tr("Unknown"));
 	}
 
-	QStandardItem *expiresItem(m_model->itemFromIndex(index.sibling(index.row(), 4)));
+	m_ui->lastModifiedLabelWidget->setText(Utils::formatDateTime(metaData.lastModified()));
+	m_ui->expiresLabelWidget->setText(Utils::formatDateTime(metaData.expirationDate()));
 
-	if (expiresItem && expiresItem->text().isEmpty())
+	if (!preview.isNull())
 	{
-		expiresItem->setText(metaData.expirationDate().toString());
+		m_ui->previewLabel->show();
+		m_ui->previewLabel->setPixmap(preview);
 	}
 
 	if (device)
 	{
-		QStandardItem *sizeItem(m_model->itemFromIndex(index.sibling(index.row(), 2)));
-
-		if (sizeItem && sizeItem->text().isEmpty())
-		{
-			sizeItem->setText(Utils::formatUnit(device->size()));
-			sizeItem->setData(device->size(), SizeRole);
-
-			QStandardItem *domainSizeItem(sizeItem->parent() ? m_model->item(sizeItem->parent()->row(), 2) : nullptr);
-
-			if (domainSizeItem)
-			{
-				domainSizeItem->setData((domainSizeItem->data(SizeRole).toLongLong() + device->size()), SizeRole);
-				domainSizeItem->setText(Utils::formatUnit(domainSizeItem->data(SizeRole).toLongLong()));
-			}
-		}
-
 		device->deleteLater();
 	}
 
 	emit categorizedActionsStateChanged({ActionsManager::ActionDefinition::EditingCategory});
 }
 
-QStandardItem* CacheContentsWidget::findDomainItem(const QString &domain)
-{
-	for (int i = 0; i < m_model->rowCount(); ++i)
-	{
-		QStandardItem *domainItem(m_model->item(i, 0));
-
-		if (domainItem && domain == domainItem->toolTip())
-		{
-			return domainItem;
-		}
-	}
-
-	return nullptr;
-}
-
-QUrl CacheContentsWidget::getEntry(const QModelIndex &index) const
-{
-	if (index.isValid() && index.parent().isValid() && index.parent().parent() == m_model->invisibleRootItem()->index())
-	{
-		return index.sibling(index.row(), 0).data(UrlRole).toUrl();
-	}
-
-	return {};
-}
-
 ActionsManager::ActionDefinition::State CacheContentsWidget::getActionState(int identifier, const QVariantMap &parameters) const
 {
 	if (identifier == ActionsManager::DeleteAction)
@@ -561,7 +346,7 @@ ActionsManager::ActionDefinition::State CacheContentsWidget::getActionState(int
 
 WebWidget::LoadingState CacheContentsWidget::getLoadingState() const
 {
-	return (m_isLoading ? WebWidget::OngoingLoadingState : WebWidget::FinishedLoadingState);
+	return (m_model->isLoading() ? WebWidget::OngoingLoadingState : WebWidget::FinishedLoadingState);
 }
 
 bool CacheContentsWidget::eventFilter(QObject *object, QEvent *event)
@@ -591,15 +376,8 @@ bool CacheContentsWidget::eventFilter(QObject *object, QEvent *event)
 
 		if ((mouseEvent->button() == Qt::LeftButton && mouseEvent->modifiers() != Qt::NoModifier) || mouseEvent->button() == Qt::MiddleButton)
 		{
-			const QModelIndex entryIndex(m_ui->cacheViewWidget->currentIndex());
-
-			if (!entryIndex.isValid() || entryIndex.parent() == m_model->invisibleRootItem()->index())
-			{
-				return ContentsWidget::eventFilter(object, event);
-			}
-
 			MainWindow *mainWindow(MainWindow::findMainWindow(this));
-			const QUrl url(getEntry(entryIndex));
+			const QUrl url(m_model->getUrl(m_ui->cacheViewWidget->currentIndex()));
 
 			if (mainWindow && url.isValid())
 			{
@@ -20,10 +20,9 @@
 #ifndef OTTER_CacheContentsWidget_H
 #define OTTER_CacheContentsWidget_H
 
+#include "CacheModel.h"
 #include "../../../ui/ContentsWidget.h"
 
-#include <QtGui/QStandardItemModel>
-
 namespace Otter
 {
 
@@ -39,12 +38,6 @@ class CacheContentsWidget final : public SpecialPageContentsWidget
 	Q_OBJECT
 
 public:
-	enum DataRole
-	{
-		UrlRole = Qt::UserRole,
-		SizeRole
-	};
-
 	explicit CacheContentsWidget(const QVariantMap &parameters, Window *window, QWidget *parent);
 	~CacheContentsWidget();
 
@@ -58,22 +51,16 @@ public slots:
 
 protected:
 	void changeEvent(QEvent *event) override;
-	QStandardItem* findDomainItem(const QString &domain);
-	QUrl getEntry(const QModelIndex &index) const;
 
 protected slots:
-	void populateCache();
 	void removeDomainEntries();
 	void removeDomainEntriesOrEntry();
 	void openEntry();
-	void handleEntryAdded(const QUrl &url);
-	void handleEntryRemoved(const QUrl &url);
 	void showContextMenu(const QPoint &position);
 	void updateActions();
 
 private:
-	QStandardItemModel *m_model;
-	bool m_isLoading;
+	CacheModel *m_model;
 	Ui::CacheContentsWidget *m_ui;
 };
 
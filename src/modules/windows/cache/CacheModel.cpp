@@ -0,0 +1,655 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2026 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "CacheModel.h"
+#include "../../../core/HistoryManager.h"
+#include "../../../core/NetworkCache.h"
+#include "../../../core/Utils.h"
+#include "../../../ui/ItemViewWidget.h"
+
+#include <QtCore/QTimerEvent>
+
+#include <algorithm>
+
+namespace Otter
+{
+
+CacheModel::CacheModel(NetworkCache *cache, QObject *parent) : QAbstractItemModel(parent),
+	m_cache(cache),
+	m_sortOrder(Qt::AscendingOrder),
+	m_sortColumn(0),
+	m_pendingPosition(-1),
+	m_populateTimer(0)
+{
+	populateModel();
+
+	connect(cache, &NetworkCache::cleared, this, &CacheModel::populateModel);
+	connect(cache, &NetworkCache::entryAdded, this, &CacheModel::handleEntryAdded);
+	connect(cache, &NetworkCache::entryRemoved, this, &CacheModel::handleEntryRemoved);
+}
+
+CacheModel::~CacheModel()
+{
+	qDeleteAll(m_hosts);
+}
+
+void CacheModel::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != m_populateTimer)
+	{
+		return;
+	}
+
+	if (m_pendingPosition < 0)
+	{
+		m_pendingEntries = m_cache->getEntries();
+		m_pendingPosition = 0;
+
+		return;
+	}
+
+	const int limit(qMin((m_pendingPosition + 1000), static_cast<int>(m_pendingEntries.count())));
+
+	for (; m_pendingPosition < limit; ++m_pendingPosition)
+	{
+		handleEntryAdded(m_pendingEntries.at(m_pendingPosition));
+	}
+
+	if (m_pendingPosition >= m_pendingEntries.count())
+	{
+		killTimer(m_populateTimer);
+
+		m_populateTimer = 0;
+
+		m_pendingEntries.clear();
+
+		emit loadingFinished();
+	}
+}
+
+void CacheModel::populateModel()
+{
+	beginResetModel();
+
+	qDeleteAll(m_hosts);
+
+	m_hosts.clear();
+	m_entries.clear();
+	m_pendingEntries.clear();
+	m_pendingPosition = -1;
+
+	endResetModel();
+
+	if (m_populateTimer == 0)
+	{
+		m_populateTimer = startTimer(0);
+	}
+}
+
+void CacheModel::fetchMore(const QModelIndex &parent)
+{
+	if (!canFetchMore(parent))
+	{
+		return;
+	}
+
+	HostEntry *hostEntry(getHostEntry(parent));
+
+	sortEntries(hostEntry);
+
+	beginInsertRows(parent, 0, (hostEntry->urls.count() - 1));
+
+	hostEntry->isFetched = true;
+
+	endInsertRows();
+}
+
+void CacheModel::sort(int column, Qt::SortOrder order)
+{
+	if (column < 0 || column >= columnCount() || (column == m_sortColumn && order == m_sortOrder))
+	{
+		return;
+	}
+
+	m_sortColumn = column;
+	m_sortOrder = order;
+
+	emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+	const QModelIndexList oldIndexes(persistentIndexList());
+	QVector<QUrl> urls;
+	urls.reserve(oldIndexes.count());
+
+	for (const QModelIndex &oldIndex: oldIndexes)
+	{
+		urls.append(getUrl(oldIndex));
+	}
+
+	for (HostEntry *hostEntry: std::as_const(m_hosts))
+	{
+		if (hostEntry->isFetched)
+		{
+			sortEntries(hostEntry);
+		}
+	}
+
+	QModelIndexList newIndexes;
+	newIndexes.reserve(oldIndexes.count());
+
+	for (int i = 0; i < oldIndexes.count(); ++i)
+	{
+		const QModelIndex &oldIndex(oldIndexes.at(i));
+
+		if (urls.at(i).isValid())
+		{
+			HostEntry *hostEntry(static_cast<HostEntry*>(oldIndex.internalPointer()));
+
+			newIndexes.append(createIndex(hostEntry->urls.indexOf(urls.at(i)), oldIndex.column(), hostEntry));
+		}
+		else
+		{
+			newIndexes.append(oldIndex);
+		}
+	}
+
+	changePersistentIndexList(oldIndexes, newIndexes);
+
+	emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void CacheModel::sortEntries(HostEntry *host)
+{
+	std::sort(host->urls.begin(), host->urls.end(), [&](const QUrl &first, const QUrl &second)
+	{
+		return isLessThan(first, second);
+	});
+}
+
+void CacheModel::handleEntryAdded(const QUrl &url)
+{
+	if (m_entries.contains(url))
+	{
+		return;
+	}
+
+	const NetworkCache::EntryInformation entry(m_cache->getEntry(url));
+
+	if (entry.path.isEmpty())
+	{
+		return;
+	}
+
+	m_entries.insert(url);
+
+	const QString host(url.host());
+	const int row(getHostRow(host));
+
+	if (row >= m_hosts.count() || m_hosts.at(row)->host != host)
+	{
+		HostEntry *hostEntry(new HostEntry());
+		hostEntry->host = host;
+		hostEntry->urls.append(url);
+
+		beginInsertRows({}, row, row);
+
+		m_hosts.insert(row, hostEntry);
+
+		endInsertRows();
+
+		return;
+	}
+
+	HostEntry *hostEntry(m_hosts.at(row));
+
+	if (hostEntry->isFetched)
+	{
+		const int entryRow(static_cast<int>(std::lower_bound(hostEntry->urls.begin(), hostEntry->urls.end(), url, [&](const QUrl &first, const QUrl &second)
+		{
+			return isLessThan(first, second);
+		}) - hostEntry->urls.begin()));
+
+		beginInsertRows(index(row, 0), entryRow, entryRow);
+
+		hostEntry->urls.insert(entryRow, url);
+
+		endInsertRows();
+	}
+	else
+	{
+		hostEntry->urls.append(url);
+	}
+
+	if (hostEntry->size >= 0)
+	{
+		hostEntry->size += entry.size;
+	}
+
+	emit dataChanged(index(row, 0), index(row, 2));
+}
+
+void CacheModel::handleEntryRemoved(const QUrl &url)
+{
+	if (!m_entries.remove(url))
+	{
+		return;
+	}
+
+	const QString host(url.host());
+	const int row(getHostRow(host));
+
+	if (row >= m_hosts.count() || m_hosts.at(row)->host != host)
+	{
+		return;
+	}
+
+	HostEntry *hostEntry(m_hosts.at(row));
+	const int entryRow(hostEntry->urls.indexOf(url));
+
+	if (entryRow < 0)
+	{
+		return;
+	}
+
+	if (hostEntry->urls.count() == 1)
+	{
+		beginRemoveRows({}, row, row);
+
+		m_hosts.removeAt(row);
+
+		endRemoveRows();
+
+		delete hostEntry;
+
+		return;
+	}
+
+	if (hostEntry->isFetched)
+	{
+		beginRemoveRows(index(row, 0), entryRow, entryRow);
+
+		hostEntry->urls.removeAt(entryRow);
+
+		endRemoveRows();
+	}
+	else
+	{
+		hostEntry->urls.removeAt(entryRow);
+	}
+
+	hostEntry->size = -1;
+
+	emit dataChanged(index(row, 0), index(row, 2));
+}
+
+CacheModel::HostEntry* CacheModel::getHostEntry(const QModelIndex &index) const
+{
+	if (!index.isValid() || index.model() != this)
+	{
+		return nullptr;
+	}
+
+	if (index.internalPointer())
+	{
+		return static_cast<HostEntry*>(index.internalPointer());
+	}
+
+	return m_hosts.value(index.row(), nullptr);
+}
+
+QModelIndex CacheModel::index(int row, int column, const QModelIndex &parent) const
+{
+	if (row < 0 || column < 0 || column >= columnCount())
+	{
+		return {};
+	}
+
+	if (!parent.isValid())
+	{
+		return ((row < m_hosts.count()) ? createIndex(row, column) : QModelIndex());
+	}
+
+	HostEntry *hostEntry((isHost(parent) && parent.column() == 0) ? getHostEntry(parent) : nullptr);
+
+	if (hostEntry && hostEntry->isFetched && row < hostEntry->urls.count())
+	{
+		return createIndex(row, column, hostEntry);
+	}
+
+	return {};
+}
+
+QModelIndex CacheModel::parent(const QModelIndex &index) const
+{
+	if (!index.isValid() || !index.internalPointer())
+	{
+		return {};
+	}
+
+	return createIndex(getHostRow(static_cast<HostEntry*>(index.internalPointer())->host), 0);
+}
+
+QUrl CacheModel::getUrl(const QModelIndex &index) const
+{
+	if (isHost(index))
+	{
+		return {};
+	}
+
+	const HostEntry *hostEntry(getHostEntry(index));
+
+	return (hostEntry ? hostEntry->urls.value(index.row()) : QUrl());
+}
+
+QString CacheModel::getHost(const QModelIndex &index) const
+{
+	const HostEntry *hostEntry(getHostEntry(index));
+
+	return (hostEntry ? hostEntry->host : QString());
+}
+
+QVariant CacheModel::data(const QModelIndex &index, int role) const
+{
+	HostEntry *hostEntry(getHostEntry(index));
+
+	if (!hostEntry)
+	{
+		return {};
+	}
+
+	if (isHost(index))
+	{
+		if (index.column() == 0)
+		{
+			switch (role)
+			{
+				case Qt::DisplayRole:
+					return QStringLiteral("%1 (%2)").arg(hostEntry->host, QString::number(hostEntry->urls.count()));
+				case Qt::DecorationRole:
+					return HistoryManager::getIcon(QUrl(QStringLiteral("http://%1/").arg(hostEntry->host)));
+				case Qt::ToolTipRole:
+					return hostEntry->host;
+				default:
+					break;
+			}
+		}
+		else if (index.column() == 2)
+		{
+			if (role == Qt::DisplayRole)
+			{
+				return Utils::formatUnit(getHostSize(hostEntry));
+			}
+
+			if (role == SizeRole)
+			{
+				return getHostSize(hostEntry);
+			}
+		}
+
+		return {};
+	}
+
+	const QUrl url(hostEntry->urls.value(index.row()));
+
+	if (role == UrlRole)
+	{
+		return ((index.column() == 0) ? url : QVariant());
+	}
+
+	if (role != Qt::DisplayRole && role != SizeRole)
+	{
+		return {};
+	}
+
+	const NetworkCache::EntryInformation entry(m_cache->getEntry(url));
+
+	if (role == SizeRole)
+	{
+		return ((index.column() == 2) ? entry.size : QVariant());
+	}
+
+	switch (index.column())
+	{
+		case 0:
+			return url.path();
+		case 1:
+			return entry.mimeType;
+		case 2:
+			return ((entry.size > 0) ? Utils::formatUnit(entry.size) : QString());
+		case 3:
+			return Utils::formatDateTime(entry.lastModified);
+		case 4:
+			return Utils::formatDateTime(entry.expirationDate);
+		default:
+			break;
+	}
+
+	return {};
+}
+
+QVariant CacheModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation != Qt::Horizontal)
+	{
+		return QAbstractItemModel::headerData(section, orientation, role);
+	}
+
+	if (role == Qt::DisplayRole)
+	{
+		switch (section)
+		{
+			case 0:
+				return tr("Address");
+			case 1:
+				return tr("Type");
+			case 2:
+				return tr("Size");
+			case 3:
+				return tr("Last Modified");
+			case 4:
+				return tr("Expires");
+			default:
+				break;
+		}
+	}
+	else if (role == HeaderViewWidget::WidthRole)
+	{
+		switch (section)
+		{
+			case 0:
+				return 500;
+			case 2:
+				return 150;
+			default:
+				break;
+		}
+	}
+
+	return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+Qt::ItemFlags CacheModel::flags(const QModelIndex &index) const
+{
+	if (!index.isValid())
+	{
+		return Qt::NoItemFlags;
+	}
+
+	if (isHost(index))
+	{
+		return (Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+	}
+
+	return (Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemNeverHasChildren);
+}
+
+QVector<QUrl> CacheModel::getUrls(const QString &host) const
+{
+	const int row(getHostRow(host));
+
+	if (row < m_hosts.count() && m_hosts.at(row)->host == host)
+	{
+		return m_hosts.at(row)->urls;
+	}
+
+	return {};
+}
+
+qint64 CacheModel::getHostSize(HostEntry *host) const
+{
+	if (host->size < 0)
+	{
+		host->size = 0;
+
+		for (const QUrl &url: std::as_const(host->urls))
+		{
+			host->size += m_cache->getEntry(url).size;
+		}
+	}
+
+	return host->size;
+}
+
+int CacheModel::getHostRow(const QString &host) const
+{
+	return static_cast<int>(std::lower_bound(m_hosts.constBegin(), m_hosts.constEnd(), host, [](const HostEntry *entry, const QString &value)
+	{
+		return (entry->host < value);
+	}) - m_hosts.constBegin());
+}
+
+int CacheModel::rowCount(const QModelIndex &parent) const
+{
+	if (!parent.isValid())
+	{
+		return m_hosts.count();
+	}
+
+	if (isHost(parent) && parent.column() == 0)
+	{
+		const HostEntry *hostEntry(getHostEntry(parent));
+
+		return ((hostEntry && hostEntry->isFetched) ? hostEntry->urls.count() : 0);
+	}
+
+	return 0;
+}
+
+int CacheModel::columnCount(const QModelIndex &parent) const
+{
+	Q_UNUSED(parent)
+
+	return 5;
+}
+
+bool CacheModel::canFetchMore(const QModelIndex &parent) const
+{
+	if (!isHost(parent) || parent.column() != 0)
+	{
+		return false;
+	}
+
+	const HostEntry *hostEntry(getHostEntry(parent));
+
+	return (hostEntry && !hostEntry->isFetched && !hostEntry->urls.isEmpty());
+}
+
+bool CacheModel::hasChildren(const QModelIndex &parent) const
+{
+	if (!parent.isValid())
+	{
+		return !m_hosts.isEmpty();
+	}
+
+	if (isHost(parent) && parent.column() == 0)
+	{
+		const HostEntry *hostEntry(getHostEntry(parent));
+
+		return (hostEntry && !hostEntry->urls.isEmpty());
+	}
+
+	return false;
+}
+
+bool CacheModel::isHost(const QModelIndex &index) const
+{
+	return (index.isValid() && index.model() == this && !index.internalPointer());
+}
+
+bool CacheModel::isLessThan(const QUrl &first, const QUrl &second) const
+{
+	const QUrl &left((m_sortOrder == Qt::AscendingOrder) ? first : second);
+	const QUrl &right((m_sortOrder == Qt::AscendingOrder) ? second : first);
+
+	if (m_sortColumn > 0)
+	{
+		const NetworkCache::EntryInformation leftEntry(m_cache->getEntry(left));
+		const NetworkCache::EntryInformation rightEntry(m_cache->getEntry(right));
+
+		switch (m_sortColumn)
+		{
+			case 1:
+				if (leftEntry.mimeType != rightEntry.mimeType)
+				{
+					return (leftEntry.mimeType < rightEntry.mimeType);
+				}
+
+				break;
+			case 2:
+				if (leftEntry.size != rightEntry.size)
+				{
+					return (leftEntry.size < rightEntry.size);
+				}
+
+				break;
+			case 3:
+				if (leftEntry.lastModified != rightEntry.lastModified)
+				{
+					return (leftEntry.lastModified < rightEntry.lastModified);
+				}
+
+				break;
+			case 4:
+				if (leftEntry.expirationDate != rightEntry.expirationDate)
+				{
+					return (leftEntry.expirationDate < rightEntry.expirationDate);
+				}
+
+				break;
+			default:
+				break;
+		}
+	}
+
+	const QString leftPath(left.path());
+	const QString rightPath(right.path());
+
+	if (leftPath != rightPath)
+	{
+		return (leftPath < rightPath);
+	}
+
+	return (left.toString() < right.toString());
+}
+
+bool CacheModel::isLoading() const
+{
+	return (m_populateTimer != 0);
+}
+
+}
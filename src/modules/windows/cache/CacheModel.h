@@ -0,0 +1,98 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2026 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_CACHEMODEL_H
+#define OTTER_CACHEMODEL_H
+
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QSet>
+#include <QtCore/QUrl>
+
+namespace Otter
+{
+
+class NetworkCache;
+
+class CacheModel final : public QAbstractItemModel
+{
+	Q_OBJECT
+
+public:
+	enum DataRole
+	{
+		UrlRole = Qt::UserRole,
+		SizeRole
+	};
+
+	explicit CacheModel(NetworkCache *cache, QObject *parent = nullptr);
+	~CacheModel();
+
+	void fetchMore(const QModelIndex &parent) override;
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+	QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+	QModelIndex parent(const QModelIndex &index) const override;
+	QUrl getUrl(const QModelIndex &index) const;
+	QString getHost(const QModelIndex &index) const;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+	Qt::ItemFlags flags(const QModelIndex &index) const override;
+	QVector<QUrl> getUrls(const QString &host) const;
+	int rowCount(const QModelIndex &parent = {}) const override;
+	int columnCount(const QModelIndex &parent = {}) const override;
+	bool canFetchMore(const QModelIndex &parent) const override;
+	bool hasChildren(const QModelIndex &parent = {}) const override;
+	bool isHost(const QModelIndex &index) const;
+	bool isLoading() const;
+
+protected:
+	struct HostEntry final
+	{
+		QString host;
+		QVector<QUrl> urls;
+		qint64 size = -1;
+		bool isFetched = false;
+	};
+
+	void timerEvent(QTimerEvent *event) override;
+	void populateModel();
+	void sortEntries(HostEntry *host);
+	void handleEntryAdded(const QUrl &url);
+	void handleEntryRemoved(const QUrl &url);
+	HostEntry* getHostEntry(const QModelIndex &index) const;
+	qint64 getHostSize(HostEntry *host) const;
+	int getHostRow(const QString &host) const;
+	bool isLessThan(const QUrl &first, const QUrl &second) const;
+
+private:
+	NetworkCache *m_cache;
+	QVector<HostEntry*> m_hosts;
+	QVector<QUrl> m_pendingEntries;
+	QSet<QUrl> m_entries;
+	Qt::SortOrder m_sortOrder;
+	int m_sortColumn;
+	int m_pendingPosition;
+	int m_populateTimer;
+
+signals:
+	void loadingFinished();
+};
+
+}
+
+#endif
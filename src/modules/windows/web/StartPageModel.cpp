@@ -19,22 +19,39 @@
 
 #include "StartPageModel.h"
 #include "../../../core/AddonsManager.h"
+#include "../../../core/Application.h"
 #include "../../../core/BookmarksManager.h"
+#include "../../../core/JsonSettings.h"
 #include "../../../core/SessionsManager.h"
 #include "../../../core/SettingsManager.h"
 #include "../../../core/WebBackend.h"
 
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QFile>
+#include <QtCore/QJsonObject>
 #include <QtCore/QMimeData>
 #include <QtCore/QTimer>
+#include <QtCore/QTimerEvent>
 #include <QtGui/QPainter>
 
+#include <algorithm>
+
 namespace Otter
 {
 
 StartPageModel::StartPageModel(QObject *parent) : QStandardItemModel(parent),
-	m_bookmark(nullptr)
+	m_bookmark(nullptr),
+	m_saveTimer(0)
 {
+	const QJsonObject tagsObject(JsonSettings(SessionsManager::getWritableDataPath(QLatin1String("thumbnails/index.json"))).object());
+
+	m_thumbnailTags.reserve(tagsObject.count());
+
+	for (QJsonObject::const_iterator iterator = tagsObject.constBegin(); iterator != tagsObject.constEnd(); ++iterator)
+	{
+		m_thumbnailTags[iterator.key().toULongLong()] = iterator.value().toString().toLatin1();
+	}
+
 	reloadModel();
 
 	connect(BookmarksManager::getModel(), &BookmarksModel::bookmarkAdded, this, &StartPageModel::handleBookmarkModified);
@@ -43,6 +60,7 @@ StartPageModel::StartPageModel(QObject *parent) : QStandardItemModel(parent),
 	connect(BookmarksManager::getModel(), &BookmarksModel::bookmarkMoved, this, &StartPageModel::handleBookmarkMoved);
 	connect(BookmarksManager::getModel(), &BookmarksModel::bookmarkTrashed, this, &StartPageModel::handleBookmarkMoved);
 	connect(BookmarksManager::getModel(), &BookmarksModel::bookmarkRemoved, this, &StartPageModel::handleBookmarkRemoved);
+	connect(BookmarksManager::getModel(), &BookmarksModel::loadingFinished, this, &StartPageModel::reloadModel);
 	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &StartPageModel::handleOptionChanged);
 }
 
@@ -83,7 +101,7 @@ void StartPageModel::reloadModel()
 				item->setData(true, IsEmptyRole);
 			}
 
-			if (url.isValid() && !QFile::exists(getThumbnailPath(identifier)))
+			if (url.isValid() && !isThumbnailValid(url, identifier))
 			{
 				requestThumbnail(url, identifier);
 			}
@@ -106,6 +124,155 @@ void StartPageModel::reloadModel()
 	emit modelModified();
 }
 
+void StartPageModel::prioritizeTiles(const QVector<quint64> &identifiers)
+{
+	if (m_thumbnailRequests.count() > 1)
+	{
+		std::stable_partition(m_thumbnailRequests.begin(), m_thumbnailRequests.end(), [&](const ThumbnailRequest &request)
+		{
+			return identifiers.contains(request.identifier);
+		});
+	}
+}
+
+void StartPageModel::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_saveTimer)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		save();
+	}
+}
+
+void StartPageModel::processThumbnailRequests()
+{
+	QHash<quint64, ThumbnailRequest>::iterator iterator(m_thumbnailJobs.begin());
+
+	while (iterator != m_thumbnailJobs.end())
+	{
+		if (iterator.value().job)
+		{
+			++iterator;
+		}
+		else
+		{
+			iterator = m_thumbnailJobs.erase(iterator);
+		}
+	}
+
+	const QSize size(getThumbnailSize());
+	int i(0);
+
+	while (m_thumbnailJobs.count() < 3 && i < m_thumbnailRequests.count())
+	{
+		if (m_thumbnailJobs.contains(m_thumbnailRequests.at(i).identifier))
+		{
+			++i;
+
+			continue;
+		}
+
+		ThumbnailRequest request(m_thumbnailRequests.takeAt(i));
+		WebPageThumbnailJob *job(AddonsManager::getWebBackend()->createPageThumbnailJob(request.url, size));
+
+		if (!job)
+		{
+			const BookmarksModel::Bookmark *bookmark(BookmarksManager::getModel()->getBookmark(request.identifier));
+
+			m_tileReloads.remove(request.identifier);
+
+			if (bookmark)
+			{
+				const QModelIndex bookmarkIndex(bookmark->index());
+
+				emit isReloadingTileChanged(index(bookmarkIndex.row(), bookmarkIndex.column()));
+			}
+
+			continue;
+		}
+
+		request.job = job;
+		request.size = size;
+
+		m_thumbnailJobs[request.identifier] = request;
+
+		connect(job, &WebPageThumbnailJob::jobFinished, this, [=]()
+		{
+			m_thumbnailJobs.remove(request.identifier);
+
+			handleThumbnailCreated(request.identifier, createThumbnailTag(request.url, request.size), job->getThumbnail(), job->getTitle());
+			processThumbnailRequests();
+		});
+
+		job->start();
+	}
+}
+
+void StartPageModel::removeThumbnail(quint64 identifier)
+{
+	const QString path(getThumbnailPath(identifier));
+
+	if (QFile::exists(path))
+	{
+		QFile::remove(path);
+	}
+
+	for (int i = (m_thumbnailRequests.count() - 1); i >= 0; --i)
+	{
+		if (m_thumbnailRequests.at(i).identifier == identifier)
+		{
+			m_thumbnailRequests.removeAt(i);
+		}
+	}
+
+	if (m_thumbnailTags.remove(identifier) > 0)
+	{
+		scheduleSave();
+	}
+}
+
+void StartPageModel::scheduleSave()
+{
+	if (Application::isAboutToQuit())
+	{
+		if (m_saveTimer != 0)
+		{
+			killTimer(m_saveTimer);
+
+			m_saveTimer = 0;
+		}
+
+		save();
+	}
+	else if (m_saveTimer == 0)
+	{
+		m_saveTimer = startTimer(1000);
+	}
+}
+
+void StartPageModel::save()
+{
+	if (SessionsManager::isReadOnly())
+	{
+		return;
+	}
+
+	QJsonObject tagsObject;
+	QHash<quint64, QByteArray>::const_iterator iterator;
+
+	for (iterator = m_thumbnailTags.constBegin(); iterator != m_thumbnailTags.constEnd(); ++iterator)
+	{
+		tagsObject.insert(QString::number(iterator.key()), QString::fromLatin1(iterator.value()));
+	}
+
+	JsonSettings settings;
+	settings.setObject(tagsObject);
+	settings.save(SessionsManager::getWritableDataPath(QLatin1String("thumbnails/index.json")));
+}
+
 void StartPageModel::handleOptionChanged(int identifier)
 {
 	switch (identifier)
@@ -164,12 +331,7 @@ void StartPageModel::handleBookmarkMoved(BookmarksModel::Bookmark *bookmark, Boo
 
 	if (bookmark->parent() != m_bookmark)
 	{
-		const QString path(getThumbnailPath(bookmark->getIdentifier()));
-
-		if (QFile::exists(path))
-		{
-			QFile::remove(path);
-		}
+		removeThumbnail(bookmark->getIdentifier());
 	}
 
 	if (bookmark == m_bookmark || previousParent == m_bookmark || m_bookmark->isAncestorOf(bookmark) || m_bookmark->isAncestorOf(previousParent))
@@ -182,18 +344,13 @@ void StartPageModel::handleBookmarkRemoved(BookmarksModel::Bookmark *bookmark, B
 {
 	if (m_bookmark && (bookmark == m_bookmark || previousParent == m_bookmark || m_bookmark->isAncestorOf(previousParent)))
 	{
-		const QString path(getThumbnailPath(bookmark->getIdentifier()));
-
-		if (QFile::exists(path))
-		{
-			QFile::remove(path);
-		}
+		removeThumbnail(bookmark->getIdentifier());
 
 		QTimer::singleShot(100, this, &StartPageModel::reloadModel);
 	}
 }
 
-void StartPageModel::handleThumbnailCreated(quint64 identifier, const QPixmap &thumbnail, const QString &title)
+void StartPageModel::handleThumbnailCreated(quint64 identifier, const QByteArray &tag, const QPixmap &thumbnail, const QString &title)
 {
 	if (!m_tileReloads.contains(identifier))
 	{
@@ -201,18 +358,25 @@ void StartPageModel::handleThumbnailCreated(quint64 identifier, const QPixmap &t
 	}
 
 	const bool needsTitleUpdate(m_tileReloads[identifier]);
+	const bool isRequested(std::any_of(m_thumbnailRequests.begin(), m_thumbnailRequests.end(), [&](const ThumbnailRequest &request)
+	{
+		return (request.identifier == identifier);
+	}));
 	BookmarksModel::Bookmark *bookmark(BookmarksManager::getModel()->getBookmark(identifier));
 
-	m_tileReloads.remove(identifier);
+	if (!isRequested)
+	{
+		m_tileReloads.remove(identifier);
+	}
 
-	if (!bookmark && SessionsManager::isReadOnly() && !thumbnail.isNull())
+	if (bookmark && !SessionsManager::isReadOnly() && !thumbnail.isNull() && Utils::ensureDirectoryExists(SessionsManager::getWritableDataPath(QLatin1String("thumbnails/"))) && thumbnail.save(getThumbnailPath(identifier), "png"))
 	{
-		Utils::ensureDirectoryExists(SessionsManager::getWritableDataPath(QLatin1String("thumbnails/")));
+		m_thumbnailTags[identifier] = tag;
 
-		thumbnail.save(getThumbnailPath(identifier), "png");
+		scheduleSave();
 	}
 
-	if (bookmark)
+	if (bookmark && !isRequested)
 	{
 		if (needsTitleUpdate)
 		{
@@ -274,6 +438,18 @@ BookmarksModel::Bookmark* StartPageModel::getBookmark(const QModelIndex &index)
 	return (data.isValid() ? BookmarksManager::getModel()->getBookmark(data.toULongLong()) : nullptr);
 }
 
+QByteArray StartPageModel::createThumbnailTag(const QUrl &url, const QSize &size)
+{
+	const QString tag(url.toString() + QLatin1Char(' ') + QString::number(size.width()) + QLatin1Char('x') + QString::number(size.height()));
+
+	return QCryptographicHash::hash(tag.toUtf8(), QCryptographicHash::Md5).toHex();
+}
+
+QSize StartPageModel::getThumbnailSize()
+{
+	return {SettingsManager::getOption(SettingsManager::StartPage_TileWidthOption).toInt(), SettingsManager::getOption(SettingsManager::StartPage_TileHeightOption).toInt()};
+}
+
 QString StartPageModel::getThumbnailPath(quint64 identifier)
 {
 	return SessionsManager::getWritableDataPath(QLatin1String("thumbnails/")) + QString::number(identifier) + QLatin1String(".png");
@@ -341,25 +517,44 @@ bool StartPageModel::requestThumbnail(const QUrl &url, quint64 identifier, bool
 		return false;
 	}
 
-	WebPageThumbnailJob *job(AddonsManager::getWebBackend()->createPageThumbnailJob(url, {SettingsManager::getOption(SettingsManager::StartPage_TileWidthOption).toInt(), SettingsManager::getOption(SettingsManager::StartPage_TileHeightOption).toInt()}));
+	m_tileReloads[identifier] = (needsTitleUpdate || m_tileReloads.value(identifier, false));
 
-	if (!job)
+	for (int i = 0; i < m_thumbnailRequests.count(); ++i)
 	{
-		return false;
+		if (m_thumbnailRequests.at(i).identifier == identifier)
+		{
+			m_thumbnailRequests[i].url = url;
+
+			return true;
+		}
 	}
 
-	connect(job, &WebPageThumbnailJob::jobFinished, this, [=]()
+	if (m_thumbnailJobs.contains(identifier) && m_thumbnailJobs[identifier].job && m_thumbnailJobs[identifier].url == url && m_thumbnailJobs[identifier].size == getThumbnailSize())
 	{
-		handleThumbnailCreated(identifier, job->getThumbnail(), job->getTitle());
-	});
+		return true;
+	}
 
-	m_tileReloads[identifier] = needsTitleUpdate;
+	ThumbnailRequest request;
+	request.url = url;
+	request.identifier = identifier;
+
+	m_thumbnailRequests.append(request);
 
-	job->start();
+	processThumbnailRequests();
 
 	return true;
 }
 
+bool StartPageModel::isThumbnailValid(const QUrl &url, quint64 identifier) const
+{
+	if (!QFile::exists(getThumbnailPath(identifier)))
+	{
+		return false;
+	}
+
+	return (!m_thumbnailTags.contains(identifier) || m_thumbnailTags[identifier] == createThumbnailTag(url, getThumbnailSize()));
+}
+
 bool StartPageModel::reloadTile(const QModelIndex &index, bool needsTitleUpdate)
 {
 	if (static_cast<BookmarksModel::BookmarkType>(index.data(BookmarksModel::TypeRole).toInt()) != BookmarksModel::UrlBookmark)
@@ -385,12 +580,12 @@ bool StartPageModel::reloadTile(const QModelIndex &index, bool needsTitleUpdate)
 
 	if (SessionsManager::isReadOnly())
 	{
-		handleThumbnailCreated(identifier, {}, information.getTitle());
+		handleThumbnailCreated(identifier, {}, {}, information.getTitle());
 
 		return false;
 	}
 
-	const QSize size(SettingsManager::getOption(SettingsManager::StartPage_TileWidthOption).toInt(), SettingsManager::getOption(SettingsManager::StartPage_TileHeightOption).toInt());
+	const QSize size(getThumbnailSize());
 	QPixmap thumbnail(size);
 	thumbnail.fill(Qt::white);
 
@@ -400,7 +595,7 @@ bool StartPageModel::reloadTile(const QModelIndex &index, bool needsTitleUpdate)
 
 	m_tileReloads[identifier] = needsTitleUpdate;
 
-	handleThumbnailCreated(identifier, thumbnail, information.getTitle());
+	handleThumbnailCreated(identifier, createThumbnailTag(url, size), thumbnail, information.getTitle());
 
 	return true;
 }
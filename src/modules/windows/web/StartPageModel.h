@@ -22,9 +22,13 @@
 
 #include "../../../core/BookmarksModel.h"
 
+#include <QtCore/QPointer>
+
 namespace Otter
 {
 
+class WebPageThumbnailJob;
+
 class StartPageModel final : public QStandardItemModel
 {
 	Q_OBJECT
@@ -50,11 +54,28 @@ public:
 
 public slots:
 	void reloadModel();
+	void prioritizeTiles(const QVector<quint64> &identifiers);
 	QModelIndex addTile(const QUrl &url);
 
 protected:
+	struct ThumbnailRequest final
+	{
+		QPointer<WebPageThumbnailJob> job;
+		QUrl url;
+		QSize size;
+		quint64 identifier = 0;
+	};
+
+	void timerEvent(QTimerEvent *event) override;
+	void processThumbnailRequests();
+	void removeThumbnail(quint64 identifier);
+	void scheduleSave();
+	void save();
 	BookmarksModel::Bookmark* getRootBookmark() const;
+	static QByteArray createThumbnailTag(const QUrl &url, const QSize &size);
+	static QSize getThumbnailSize();
 	bool requestThumbnail(const QUrl &url, quint64 identifier, bool needsTitleUpdate = false);
+	bool isThumbnailValid(const QUrl &url, quint64 identifier) const;
 
 protected slots:
 	void handleOptionChanged(int identifier);
@@ -62,11 +83,15 @@ protected slots:
 	void handleBookmarkModified(BookmarksModel::Bookmark *bookmark);
 	void handleBookmarkMoved(BookmarksModel::Bookmark *bookmark, BookmarksModel::Bookmark *previousParent);
 	void handleBookmarkRemoved(BookmarksModel::Bookmark *bookmark, BookmarksModel::Bookmark *previousParent);
-	void handleThumbnailCreated(quint64 identifier, const QPixmap &thumbnail, const QString &title);
+	void handleThumbnailCreated(quint64 identifier, const QByteArray &tag, const QPixmap &thumbnail, const QString &title);
 
 private:
 	BookmarksModel::Bookmark *m_bookmark;
+	QVector<ThumbnailRequest> m_thumbnailRequests;
+	QHash<quint64, ThumbnailRequest> m_thumbnailJobs;
+	QHash<quint64, QByteArray> m_thumbnailTags;
 	QHash<quint64, bool> m_tileReloads;
+	int m_saveTimer;
 
 signals:
 	void modelModified();
@@ -542,6 +542,8 @@ StartPageWidget::StartPageWidget(Window *parent) : QScrollArea(parent),
 
 	connect(m_model, &StartPageModel::modelModified, this, &StartPageWidget::updateSize);
 	connect(m_model, &StartPageModel::isReloadingTileChanged, this, &StartPageWidget::handleIsReloadingTileChanged);
+	connect(horizontalScrollBar(), &QScrollBar::valueChanged, this, &StartPageWidget::updateVisibleTiles);
+	connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &StartPageWidget::updateVisibleTiles);
 	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &StartPageWidget::handleOptionChanged);
 }
 
@@ -710,6 +712,7 @@ void StartPageWidget::triggerAction(int identifier, const QVariantMap &parameter
 
 				if (isReloading)
 				{
+					updateVisibleTiles();
 					startReloadingAnimation();
 				}
 			}
@@ -850,6 +853,8 @@ void StartPageWidget::reloadTile()
 {
 	if (m_currentIndex.isValid() && m_model->reloadTile(m_currentIndex))
 	{
+		m_model->prioritizeTiles({m_currentIndex.data(BookmarksModel::IdentifierRole).toULongLong()});
+
 		startReloadingAnimation();
 	}
 }
@@ -1039,6 +1044,32 @@ void StartPageWidget::updateSize()
 
 	m_currentIndex = {};
 	m_thumbnail = {};
+
+	updateVisibleTiles();
+}
+
+void StartPageWidget::updateVisibleTiles()
+{
+	if (!isVisible())
+	{
+		return;
+	}
+
+	const QRect viewportRectangle(viewport()->rect());
+	QVector<quint64> identifiers;
+
+	for (int i = 0; i < m_model->rowCount(); ++i)
+	{
+		const QModelIndex index(m_model->index(i, 0));
+		const QRect rectangle(m_listView->visualRect(index));
+
+		if (rectangle.isValid() && viewportRectangle.intersects(QRect(m_listView->viewport()->mapTo(viewport(), rectangle.topLeft()), rectangle.size())))
+		{
+			identifiers.append(index.data(BookmarksModel::IdentifierRole).toULongLong());
+		}
+	}
+
+	m_model->prioritizeTiles(identifiers);
 }
 
 void StartPageWidget::showContextMenu(const QPoint &position)
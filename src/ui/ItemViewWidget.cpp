@@ -1335,6 +1335,11 @@ bool ItemViewWidget::applyFilter(const QModelIndex &index, bool parentHasMatch)
 			m_expandedBranches.insert(index);
 		}
 
+		if (hasFilter && model()->canFetchMore(index))
+		{
+			model()->fetchMore(index);
+		}
+
 		const int rowCount(getRowCount(index));
 		bool folderHasMatch(false);
 
@@ -39,6 +39,7 @@
 #include <QtCore/QJsonDocument>
 #include <QtCore/QMetaEnum>
 #include <QtCore/QMimeDatabase>
+#include <QtCore/QTimer>
 #include <QtGui/QMouseEvent>
 #include <QtGui/QScreen>
 
@@ -50,16 +51,20 @@ int Menu::m_menuRoleIdentifierEnumerator(-1);
 Menu::Menu(QWidget *parent) : QMenu(parent),
 	m_actionGroup(nullptr),
 	m_clickedAction(nullptr),
+	m_moreBookmarksAction(nullptr),
 	m_role(UnknownMenu),
-	m_option(-1)
+	m_option(-1),
+	m_bookmarksAmount(0)
 {
 }
 
 Menu::Menu(int role, QWidget *parent) : QMenu(parent),
 	m_actionGroup(nullptr),
 	m_clickedAction(nullptr),
+	m_moreBookmarksAction(nullptr),
 	m_role(role),
-	m_option(-1)
+	m_option(-1),
+	m_bookmarksAmount(0)
 {
 	Q_UNUSED(QT_TRANSLATE_NOOP("actions", "File"))
 	Q_UNUSED(QT_TRANSLATE_NOOP("actions", "Edit"))
@@ -121,11 +126,19 @@ Menu::Menu(int role, QWidget *parent) : QMenu(parent),
 				if (!parentMenu || parentMenu->getRole() != m_role)
 				{
 					connect(BookmarksManager::getModel(), &BookmarksModel::modelModified, this, &Menu::clearBookmarksMenu);
+					connect(BookmarksManager::getModel(), &BookmarksModel::loadingFinished, this, &Menu::clearBookmarksMenu);
 				}
 
 				if (role == BookmarksMenu)
 				{
 					connect(this, &Menu::aboutToShow, this, &Menu::populateBookmarksMenu);
+					connect(this, &Menu::hovered, this, [&](QAction *action)
+					{
+						if (m_moreBookmarksAction && actions().indexOf(action) >= (actions().count() - 10))
+						{
+							appendBookmarks();
+						}
+					});
 				}
 				else
 				{
@@ -210,6 +223,7 @@ Menu::Menu(int role, QWidget *parent) : QMenu(parent),
 				if (!parentMenu || parentMenu->getRole() != m_role)
 				{
 					connect(NotesManager::getModel(), &BookmarksModel::modelModified, this, &Menu::clearNotesMenu);
+					connect(NotesManager::getModel(), &BookmarksModel::loadingFinished, this, &Menu::clearNotesMenu);
 				}
 
 				connect(this, &Menu::aboutToShow, this, &Menu::populateNotesMenu);
@@ -317,6 +331,11 @@ void Menu::hideEvent(QHideEvent *event)
 {
 	m_clickedAction = nullptr;
 
+	if (m_role == BookmarksMenu && m_bookmarksAmount > 100)
+	{
+		QTimer::singleShot(0, this, &Menu::clearBookmarksMenu);
+	}
+
 	QMenu::hideEvent(event);
 }
 
@@ -331,6 +350,15 @@ void Menu::mouseReleaseEvent(QMouseEvent *event)
 {
 	const Action *action(qobject_cast<Action*>(actionAt(event->pos())));
 
+	if (m_moreBookmarksAction && action == m_moreBookmarksAction)
+	{
+		m_clickedAction = nullptr;
+
+		appendBookmarks();
+
+		return;
+	}
+
 	if (m_role != BookmarksMenu || !(event->button() == Qt::LeftButton || event->button() == Qt::MiddleButton) || !action || action != m_clickedAction || !action->isEnabled() || action->getIdentifier() != ActionsManager::OpenBookmarkAction)
 	{
 		m_clickedAction = nullptr;
@@ -652,29 +680,20 @@ void Menu::hideMenu()
 	}
 }
 
-void Menu::populateBookmarksMenu()
+void Menu::appendBookmarks()
 {
 	const BookmarksModel::Bookmark *folderBookmark(BookmarksManager::getModel()->getBookmark(m_menuOptions.value(QLatin1String("bookmark")).toULongLong()));
 
-	if (!isEmpty() && !(folderBookmark->getType() == BookmarksModel::RootBookmark && actions().count() == 3))
+	if (!folderBookmark)
 	{
 		return;
 	}
 
 	MainWindow *mainWindow(MainWindow::findMainWindow(parent()));
 	ActionExecutor::Object executor(mainWindow, mainWindow);
+	const int amount(qMin(folderBookmark->rowCount(), (m_bookmarksAmount + 100)));
 
-	if (folderBookmark->rowCount() > 1)
-	{
-		Action *action(new OpenBookmarkMenuAction(folderBookmark->getIdentifier(), executor, this));
-		action->setTextOverride(QT_TRANSLATE_NOOP("actions", "Open All"));
-		action->setIconOverride(QLatin1String("document-open-folder"));
-
-		addAction(action);
-		addSeparator();
-	}
-
-	for (int i = 0; i < folderBookmark->rowCount(); ++i)
+	for (int i = m_bookmarksAmount; i < amount; ++i)
 	{
 		const BookmarksModel::Bookmark *bookmark(folderBookmark->getChild(i));
 
@@ -710,16 +729,76 @@ void Menu::populateBookmarksMenu()
 						}
 					}
 
-					addAction(action);
+					insertAction(m_moreBookmarksAction, action);
 				}
 
 				break;
 			default:
-				addSeparator();
+				insertSeparator(m_moreBookmarksAction);
 
 				break;
 		}
 	}
+
+	m_bookmarksAmount = amount;
+
+	if (m_bookmarksAmount < folderBookmark->rowCount())
+	{
+		if (!m_moreBookmarksAction)
+		{
+			m_moreBookmarksAction = new MenuAction(QT_TRANSLATE_NOOP("actions", "More…"), true, this);
+			m_moreBookmarksAction->setIcon(ThemesManager::createIcon(QLatin1String("go-down")));
+
+			addAction(m_moreBookmarksAction);
+		}
+	}
+	else if (m_moreBookmarksAction)
+	{
+		removeAction(m_moreBookmarksAction);
+
+		m_moreBookmarksAction->deleteLater();
+		m_moreBookmarksAction = nullptr;
+	}
+}
+
+void Menu::populateBookmarksMenu()
+{
+	if (BookmarksManager::getModel()->isLoading())
+	{
+		if (isEmpty() || (m_menuOptions.value(QLatin1String("bookmark")).toULongLong() == 0 && actions().count() == 3))
+		{
+			QAction *loadingAction(new MenuAction(QT_TRANSLATE_NOOP("actions", "(loading…)"), true, this));
+			loadingAction->setEnabled(false);
+
+			addAction(loadingAction);
+		}
+
+		return;
+	}
+
+	const BookmarksModel::Bookmark *folderBookmark(BookmarksManager::getModel()->getBookmark(m_menuOptions.value(QLatin1String("bookmark")).toULongLong()));
+
+	if (!isEmpty() && !(folderBookmark->getType() == BookmarksModel::RootBookmark && actions().count() == 3))
+	{
+		return;
+	}
+
+	MainWindow *mainWindow(MainWindow::findMainWindow(parent()));
+	ActionExecutor::Object executor(mainWindow, mainWindow);
+
+	if (folderBookmark->rowCount() > 1)
+	{
+		Action *action(new OpenBookmarkMenuAction(folderBookmark->getIdentifier(), executor, this));
+		action->setTextOverride(QT_TRANSLATE_NOOP("actions", "Open All"));
+		action->setIconOverride(QLatin1String("document-open-folder"));
+
+		addAction(action);
+		addSeparator();
+	}
+
+	m_bookmarksAmount = 0;
+
+	appendBookmarks();
 }
 
 void Menu::populateBookmarkSelectorMenu()
@@ -1595,12 +1674,21 @@ void Menu::clearBookmarksMenu()
 	for (int i = (actions().count() - 1); i >= offset; --i)
 	{
 		QAction *action(actions().at(i));
+
+		if (action->menu())
+		{
+			action->menu()->deleteLater();
+		}
+
 		action->deleteLater();
 
 		removeAction(action);
 	}
 
-	connect(this, &Menu::aboutToShow, this, &Menu::populateBookmarksMenu);
+	m_moreBookmarksAction = nullptr;
+	m_bookmarksAmount = 0;
+
+	connect(this, &Menu::aboutToShow, this, &Menu::populateBookmarksMenu, Qt::UniqueConnection);
 }
 
 void Menu::clearNotesMenu()
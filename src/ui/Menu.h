@@ -101,6 +101,7 @@ protected:
 
 protected slots:
 	void hideMenu();
+	void appendBookmarks();
 	void populateBookmarksMenu();
 	void populateBookmarkSelectorMenu();
 	void populateOptionMenu();
@@ -126,6 +127,7 @@ protected slots:
 private:
 	QActionGroup *m_actionGroup;
 	QAction *m_clickedAction;
+	QAction *m_moreBookmarksAction;
 	QString m_title;
 	ActionExecutor::Object m_executor;
 	QHash<QString, QActionGroup*> m_actionGroups;
@@ -133,6 +135,7 @@ private:
 	QVariantMap m_menuOptions;
 	int m_role;
 	int m_option;
+	int m_bookmarksAmount;
 
 	static int m_menuRoleIdentifierEnumerator;
 };
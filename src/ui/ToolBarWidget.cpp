@@ -412,6 +412,11 @@ void ToolBarWidget::populateEntries()
 
 			loadBookmarks();
 
+			if (BookmarksManager::getModel()->isLoading())
+			{
+				connect(BookmarksManager::getModel(), &BookmarksModel::loadingFinished, this, &ToolBarWidget::handleBookmarksLoadingFinished, Qt::UniqueConnection);
+			}
+
 			connect(BookmarksManager::getModel(), &BookmarksModel::bookmarkAdded, this, &ToolBarWidget::handleBookmarkModified);
 			connect(BookmarksManager::getModel(), &BookmarksModel::bookmarkModified, this, &ToolBarWidget::handleBookmarkModified);
 			connect(BookmarksManager::getModel(), &BookmarksModel::bookmarkRestored, this, &ToolBarWidget::handleBookmarkModified);
@@ -764,6 +769,18 @@ void ToolBarWidget::handleBookmarkRemoved(BookmarksModel::Bookmark *bookmark, Bo
 	}
 }
 
+void ToolBarWidget::handleBookmarksLoadingFinished()
+{
+	const ToolBarsManager::ToolBarDefinition definition(getDefinition());
+
+	if (definition.type == ToolBarsManager::BookmarksBarType)
+	{
+		m_bookmark = BookmarksManager::getBookmark(definition.bookmarksPath);
+
+		loadBookmarks();
+	}
+}
+
 void ToolBarWidget::handleFullScreenStateChanged(bool isFullScreen)
 {
 	if (getDefinition().hasToggle)
@@ -111,6 +111,7 @@ protected slots:
 	void handleBookmarkModified(BookmarksModel::Bookmark *bookmark);
 	void handleBookmarkMoved(BookmarksModel::Bookmark *bookmark, BookmarksModel::Bookmark *previousParent);
 	void handleBookmarkRemoved(BookmarksModel::Bookmark *bookmark, BookmarksModel::Bookmark *previousParent);
+	void handleBookmarksLoadingFinished();
 	void handleFullScreenStateChanged(bool isFullScreen);
 	void setToolBarLocked(bool locked);
 
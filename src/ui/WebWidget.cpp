@@ -84,6 +84,10 @@ WebWidget::WebWidget(WebBackend *backend, ContentsWidget *parent) : QWidget(pare
 	{
 		emit categorizedActionsStateChanged({ActionsManager::ActionDefinition::BookmarkCategory});
 	});
+	connect(BookmarksManager::getModel(), &BookmarksModel::loadingFinished, this, [&]()
+	{
+		emit categorizedActionsStateChanged({ActionsManager::ActionDefinition::BookmarkCategory});
+	});
 	connect(PasswordsManager::getInstance(), &PasswordsManager::passwordsModified, this, [&]()
 	{
 		emit arbitraryActionsStateChanged({ActionsManager::FillPasswordAction});